@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "bell.hpp"
+#include "uasat/bitvec.hpp"
+#include "uasat/clone.hpp"
+#include "uasat/group.hpp"
+#include "uasat/profile.hpp"
+#include "uasat/solver.hpp"
+#include "uasat/tensor.hpp"
+
+/**
+ * The outcome of a single run of a workload: the computed number (or -1 if
+ * the workload does not compute one), and the solver or the profiler used.
+ */
+struct run_t {
+  long result;
+  std::shared_ptr<uasat::Solver> solver;
+  std::shared_ptr<uasat::Profiler> profiler;
+};
+
+struct workload_t {
+  const char *name;
+  const char *description;
+  std::vector<int> sizes;
+  run_t (*run)(int size);
+  long (*expected)(int size);
+};
+
+long bell_number(int size) {
+  std::vector<long> row(1, 1);
+  for (int i = 0; i < size; i++) {
+    std::vector<long> next(1, row.back());
+    for (long a : row)
+      next.push_back(next.back() + a);
+    row.swap(next);
+  }
+  return row.front();
+}
+
+long factorial(int size) {
+  long result = 1;
+  for (int i = 2; i <= size; i++)
+    result *= i;
+  return result;
+}
+
+long power_of_two(int size) { return 1L << size; }
+
+long always_one(int) { return 1; }
+
+run_t bell_clauses(int size) {
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create("minisat");
+  return {count_equivalences_clauses(solver, size), solver, nullptr};
+}
+
+run_t bell_tensors(int size) {
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create("minisatsimp");
+  return {count_equivalences_tensors(solver, size), solver, nullptr};
+}
+
+/**
+ * Counts the elements of the group the same way as find_cardinality does,
+ * but keeps the solver for its statistics.
+ */
+run_t group_cardinality(uasat::AbstractGroup &group) {
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create();
+  uasat::Tensor elem = uasat::Tensor::variable(solver, group.get_shape());
+  solver->add_clause(group.contains(elem).get_scalar());
+
+  std::vector<uasat::literal_t> projection;
+  elem.extend_clause(projection);
+
+  long count = solver->enumerate(
+      projection, [](const uasat::bitvec_t *) { return true; });
+  return {count, solver, nullptr};
+}
+
+run_t group_axioms(uasat::AbstractGroup &group) {
+  std::shared_ptr<uasat::Profiler> profiler =
+      std::make_shared<uasat::Profiler>();
+  group.test_axioms(profiler);
+  return {-1, nullptr, profiler};
+}
+
+run_t symmetric_cardinality(int size) {
+  uasat::SymmetricGroup group(size);
+  return group_cardinality(group);
+}
+
+run_t symmetric_axioms(int size) {
+  uasat::SymmetricGroup group(size);
+  return group_axioms(group);
+}
+
+run_t binarynum_cardinality(int size) {
+  uasat::BinaryNumAddition group(size);
+  return group_cardinality(group);
+}
+
+run_t binarynum_axioms(int size) {
+  uasat::BinaryNumAddition group(size);
+  return group_axioms(group);
+}
+
+/**
+ * Colors a size by size grid with five colors such that no two points at
+ * unit distance have the same color, where the unit is 100 / 3 points. For
+ * size 100 this is the instance of plain.cpp. The result is 1 if the
+ * coloring exists.
+ */
+run_t circle_coloring(int size) {
+  const int C = 5;
+  const float T = 3.0f / size;
+  const float E = 1.42f * T;
+
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create();
+
+  std::vector<uasat::literal_t> lits(size * size * C);
+  for (size_t i = 0; i < lits.size(); i++)
+    lits[i] = solver->add_variable();
+
+  std::vector<uasat::literal_t> clause(C);
+  for (int i = 0; i < size * size; i++) {
+    for (int c = 0; c < C; c++)
+      clause[c] = lits[i * C + c];
+    solver->add_clause(clause);
+  }
+
+  std::vector<std::array<int, 2>> circle;
+  const int K = std::ceil((1.0f + E) / T);
+  for (int i = 0; i <= K; i++)
+    for (int j = -K; j <= K; j++) {
+      if (i == 0 && j < 0)
+        continue;
+      float a = i * T;
+      float b = j * T;
+      float c = std::abs(std::sqrt(a * a + b * b) - 1.0f);
+      if (c < E)
+        circle.push_back({i, j});
+    }
+
+  for (int i = 0; i < size; i++)
+    for (int j = 0; j < size; j++)
+      for (std::array<int, 2> offset : circle) {
+        int i2 = i + offset[0];
+        int j2 = j + offset[1];
+        if (0 <= i2 && i2 < size && 0 <= j2 && j2 < size)
+          for (int c = 0; c < C; c++)
+            solver->add_clause(
+                solver->logic_not(lits[(i * size + j) * C + c]),
+                solver->logic_not(lits[(i2 * size + j2) * C + c]));
+      }
+
+  return {solver->solve() ? 1 : 0, solver, nullptr};
+}
+
+/**
+ * Finds a binary operation on a set of the given size. The result is 1 if
+ * one is found.
+ */
+run_t operations_membership(int size) {
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create();
+  uasat::Operations ops(size);
+  uasat::Tensor op = uasat::Tensor::variable(solver, ops.get_shape(2));
+  solver->add_clause(ops.contains(2, op).get_scalar());
+
+  return {solver->solve() ? 1 : 0, solver, nullptr};
+}
+
+const std::vector<workload_t> WORKLOADS = {
+    {"bell-clauses", "equivalence relations with blocking clauses",
+     {4, 5, 6}, bell_clauses, bell_number},
+    {"bell-tensors", "equivalence relations with tensor enumeration",
+     {6, 7, 8}, bell_tensors, bell_number},
+    {"symmetric-cardinality", "elements of the symmetric group",
+     {3, 4, 5}, symmetric_cardinality, factorial},
+    {"symmetric-axioms", "group axioms of the symmetric group",
+     {4, 6, 8}, symmetric_axioms, nullptr},
+    {"binarynum-cardinality", "elements of binary number addition",
+     {4, 6, 8}, binarynum_cardinality, power_of_two},
+    {"binarynum-axioms", "group axioms of binary number addition",
+     {5, 8, 12}, binarynum_axioms, nullptr},
+    {"circle-coloring", "five coloring of the unit distance grid graph",
+     {30, 60, 100}, circle_coloring, nullptr},
+    {"operations-membership", "a binary operation of the clone",
+     {8, 16, 32}, operations_membership, always_one},
+};
+
+/**
+ * Runs the workload the given number of times after the warmup runs, and
+ * prints out the timings and the statistics of the last run as a JSON
+ * object. Returns false if the result is not the expected one.
+ */
+bool benchmark(const workload_t &workload, int size, int warmup, int repeats,
+               std::ostream &out) {
+  for (int i = 0; i < warmup; i++)
+    workload.run(size);
+
+  std::vector<double> times;
+  run_t run;
+  for (int i = 0; i < repeats; i++) {
+    auto start = std::chrono::steady_clock::now();
+    run = workload.run(size);
+    times.push_back(std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count());
+  }
+
+  std::vector<double> sorted = times;
+  std::sort(sorted.begin(), sorted.end());
+  double mean = 0.0;
+  for (double time : times)
+    mean += time;
+  mean /= times.size();
+
+  out << "{\"name\": \"" << workload.name << "\", \"size\": " << size
+      << ", \"warmup\": " << warmup << ", \"repeats\": " << repeats;
+
+  bool correct = true;
+  if (run.result >= 0)
+    out << ", \"result\": " << run.result;
+  if (workload.expected != nullptr) {
+    long expected = workload.expected(size);
+    correct = run.result == expected;
+    out << ", \"expected\": " << expected
+        << ", \"correct\": " << (correct ? "true" : "false");
+  }
+
+  out << ", \"time\": {\"min\": " << sorted.front()
+      << ", \"median\": " << sorted[sorted.size() / 2]
+      << ", \"mean\": " << mean << ", \"max\": " << sorted.back()
+      << ", \"runs\": [";
+  for (size_t i = 0; i < times.size(); i++)
+    out << (i != 0 ? ", " : "") << times[i];
+  out << "]}";
+
+  if (run.solver != nullptr)
+    out << ", \"variables\": " << run.solver->get_variables()
+        << ", \"clauses\": " << run.solver->get_clauses()
+        << ", \"stats\": " << run.solver->get_stats();
+  if (run.profiler != nullptr) {
+    out << ", \"profile\": ";
+    run.profiler->print_json(out);
+  }
+  out << "}";
+
+  return correct;
+}
+
+std::vector<int> parse_sizes(const std::string &arg) {
+  std::vector<int> sizes;
+  std::istringstream in(arg);
+  std::string item;
+  while (std::getline(in, item, ','))
+    sizes.push_back(std::atoi(item.c_str()));
+  return sizes;
+}
+
+void print_usage(std::ostream &out) {
+  out << "usage: uasat-bench [options] [workload...]\n"
+      << "  --warmup N     untimed runs before the measured ones (default 1)\n"
+      << "  --repeats N    measured runs of each workload (default 5)\n"
+      << "  --sizes A,B,C  overrides the default sizes of the workloads\n"
+      << "  --list         prints the workloads and their default sizes\n"
+      << "The results are printed as JSON, and the exit status is nonzero\n"
+      << "if some workload computed an incorrect result.\n";
+}
+
+int main(int argc, char **argv) {
+  int warmup = 1;
+  int repeats = 5;
+  std::vector<int> sizes;
+  std::vector<std::string> names;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--warmup" && i + 1 < argc)
+      warmup = std::max(std::atoi(argv[++i]), 0);
+    else if (arg == "--repeats" && i + 1 < argc)
+      repeats = std::max(std::atoi(argv[++i]), 1);
+    else if (arg == "--sizes" && i + 1 < argc)
+      sizes = parse_sizes(argv[++i]);
+    else if (arg == "--list") {
+      for (const workload_t &workload : WORKLOADS) {
+        std::cout << workload.name << " (";
+        for (size_t j = 0; j < workload.sizes.size(); j++)
+          std::cout << (j != 0 ? "," : "") << workload.sizes[j];
+        std::cout << "): " << workload.description << std::endl;
+      }
+      return 0;
+    } else if (arg == "--help") {
+      print_usage(std::cout);
+      return 0;
+    } else if (arg.empty() || arg[0] == '-') {
+      print_usage(std::cerr);
+      return 1;
+    } else
+      names.push_back(arg);
+  }
+
+  for (const std::string &name : names)
+    if (std::none_of(WORKLOADS.begin(), WORKLOADS.end(),
+                     [&name](const workload_t &workload) {
+                       return name == workload.name;
+                     })) {
+      std::cerr << "unknown workload: " << name << std::endl;
+      return 1;
+    }
+
+  bool correct = true;
+  bool first = true;
+  std::cout << "{\"benchmarks\": [";
+  for (const workload_t &workload : WORKLOADS) {
+    if (!names.empty() &&
+        std::find(names.begin(), names.end(), workload.name) == names.end())
+      continue;
+
+    for (int size : sizes.empty() ? workload.sizes : sizes) {
+      std::cout << (first ? "\n" : ",\n");
+      first = false;
+      correct &= benchmark(workload, size, warmup, repeats, std::cout);
+      std::cout.flush();
+    }
+  }
+  std::cout << "\n]}" << std::endl;
+
+  return correct ? 0 : 2;
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "uasat/bitvec.hpp"
+#include "uasat/solver.hpp"
+#include "uasat/tensor.hpp"
+
+// every heap allocation of the process is counted, so the kernels can be
+// charged with the bytes they allocate
+static std::atomic<size_t> allocated_bytes(0);
+static std::atomic<size_t> allocation_count(0);
+
+void *operator new(size_t size) {
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size != 0 ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+/**
+ * The input tensors of the kernels, all of shape (size, size) with a
+ * pseudo random content or fresh variables of a solver, and the slices of
+ * the first one.
+ */
+struct inputs_t {
+  std::shared_ptr<uasat::Solver> solver;
+  uasat::Tensor tensor1;
+  uasat::Tensor tensor2;
+  uasat::Tensor tensor3;
+  std::vector<uasat::Tensor> slices;
+};
+
+uasat::Tensor random_tensor(const std::vector<int> &shape, uint64_t &seed) {
+  size_t length = 1;
+  for (int dim : shape)
+    length *= dim;
+
+  uasat::bitvec_t *vec = uasat::bitvec_t::create(length);
+  for (uint64_t block = 0; block < (length + 63) / 64; block++) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    uasat::bitvec_t::set_block(vec, block, seed);
+  }
+
+  uasat::Tensor tensor = uasat::Tensor::from_bitvec(shape, vec);
+  uasat::bitvec_t::destroy(vec);
+  return tensor;
+}
+
+inputs_t make_inputs(int size, bool use_solver) {
+  std::vector<int> shape = {size, size};
+  if (use_solver) {
+    std::shared_ptr<uasat::Solver> solver = uasat::Solver::create();
+    uasat::Tensor tensor1 = uasat::Tensor::variable(solver, shape);
+    return {solver, tensor1, uasat::Tensor::variable(solver, shape),
+            uasat::Tensor::variable(solver, shape), tensor1.slices()};
+  }
+
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+  uasat::Tensor tensor1 = random_tensor(shape, seed);
+  return {nullptr, tensor1, random_tensor(shape, seed),
+          random_tensor(shape, seed), tensor1.slices()};
+}
+
+/**
+ * Folds are measured along a first axis of this length.
+ */
+const int FOLD_LENGTH = 8;
+
+uasat::Tensor fold_input(const inputs_t &in) {
+  const std::vector<int> &shape = in.tensor1.get_shape();
+  int length = shape[0] * shape[1] / FOLD_LENGTH;
+  return in.tensor1.reshape(2, {FOLD_LENGTH, length});
+}
+
+struct kernel_t {
+  const char *name;
+  bool logical;
+  uasat::Tensor (*run)(const inputs_t &in);
+};
+
+const std::vector<kernel_t> KERNELS = {
+    {"polymer-transpose", false,
+     [](const inputs_t &in) {
+       const std::vector<int> &shape = in.tensor1.get_shape();
+       return in.tensor1.polymer({shape[1], shape[0]}, {1, 0}).materialize();
+     }},
+    {"polymer-diagonal", false,
+     [](const inputs_t &in) {
+       return in.tensor1.polymer({in.tensor1.get_shape()[0]}, {0, 0})
+           .materialize();
+     }},
+    {"polymer-broadcast", false,
+     [](const inputs_t &in) {
+       const std::vector<int> &shape = in.tensor1.get_shape();
+       return in.tensor1.polymer({4, shape[0], shape[1]}, {1, 2})
+           .materialize();
+     }},
+    {"slices", false,
+     [](const inputs_t &in) { return in.tensor1.slices().back(); }},
+    {"stack", false,
+     [](const inputs_t &in) { return uasat::Tensor::stack(in.slices); }},
+    {"reshape", false,
+     [](const inputs_t &in) {
+       const std::vector<int> &shape = in.tensor1.get_shape();
+       return in.tensor1.reshape(2, {shape[0] * shape[1]});
+     }},
+    {"reshape-strided", false,
+     [](const inputs_t &in) {
+       const std::vector<int> &shape = in.tensor1.get_shape();
+       return in.tensor1.polymer({shape[1], shape[0]}, {1, 0})
+           .reshape(2, {shape[0] * shape[1]});
+     }},
+    {"logic_not", true,
+     [](const inputs_t &in) { return in.tensor1.logic_not(); }},
+    {"logic_and", true,
+     [](const inputs_t &in) { return in.tensor1.logic_and(in.tensor2); }},
+    {"logic_add", true,
+     [](const inputs_t &in) { return in.tensor1.logic_add(in.tensor2); }},
+    {"logic_maj", true,
+     [](const inputs_t &in) {
+       return in.tensor1.logic_maj(in.tensor2, in.tensor3);
+     }},
+    {"fold_all", true,
+     [](const inputs_t &in) { return fold_input(in).fold_all(); }},
+    {"fold_any", true,
+     [](const inputs_t &in) { return fold_input(in).fold_any(); }},
+    {"fold_sum", true,
+     [](const inputs_t &in) { return fold_input(in).fold_sum(); }},
+    {"fold_amo", true,
+     [](const inputs_t &in) { return fold_input(in).fold_amo(); }},
+    {"fold_one", true,
+     [](const inputs_t &in) { return fold_input(in).fold_one(); }},
+    {"fold_atleast", true,
+     [](const inputs_t &in) { return fold_input(in).fold_atleast(2); }},
+    {"fold_exactly", true,
+     [](const inputs_t &in) { return fold_input(in).fold_exactly(2); }},
+};
+
+struct measurement_t {
+  unsigned long iterations = 0;
+  double seconds = 0.0;
+  size_t bytes = 0;
+  size_t allocations = 0;
+  size_t elements = 0;
+};
+
+size_t get_elements(const uasat::Tensor &tensor) {
+  size_t elements = 1;
+  for (int dim : tensor.get_shape())
+    elements *= dim;
+  return elements;
+}
+
+/**
+ * Runs the kernel until the given time is spent in it. Over the constant
+ * logic the same inputs are reused in doubling batches, while over a solver
+ * every run gets fresh variables, so gates are never shared between runs.
+ */
+measurement_t measure(const kernel_t &kernel, int size, bool use_solver,
+                      double min_time) {
+  measurement_t result;
+  // the elements processed are the larger of the input and the output
+  inputs_t inputs = make_inputs(size, use_solver);
+  result.elements =
+      std::max(get_elements(inputs.tensor1), get_elements(kernel.run(inputs)));
+
+  for (unsigned long batch = 1; result.seconds < min_time;
+       batch = use_solver ? 1 : 2 * batch) {
+    if (use_solver)
+      inputs = make_inputs(size, use_solver);
+
+    size_t bytes = allocated_bytes.load();
+    size_t allocations = allocation_count.load();
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < batch; i++)
+      kernel.run(inputs);
+    result.seconds += std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    result.bytes += allocated_bytes.load() - bytes;
+    result.allocations += allocation_count.load() - allocations;
+    result.iterations += batch;
+  }
+
+  return result;
+}
+
+std::vector<int> parse_sizes(const std::string &arg) {
+  std::vector<int> sizes;
+  std::istringstream in(arg);
+  std::string item;
+  while (std::getline(in, item, ','))
+    sizes.push_back(std::atoi(item.c_str()));
+  return sizes;
+}
+
+void print_usage(std::ostream &out) {
+  out << "usage: uasat-microbench [options] [kernel...]\n"
+      << "  --sizes A,B,C   sides of the square inputs, multiples of 4\n"
+      << "                  (default 4,32,256,2048)\n"
+      << "  --solver-max N  largest side measured over a solver (default 256)\n"
+      << "  --min-time S    seconds spent in each measurement (default 0.2)\n"
+      << "  --list          prints the kernels\n"
+      << "The results are printed as JSON, with the time in nanoseconds and\n"
+      << "the allocated bytes per call of the kernel.\n";
+}
+
+int main(int argc, char **argv) {
+  std::vector<int> sizes = {4, 32, 256, 2048};
+  int solver_max = 256;
+  double min_time = 0.2;
+  std::vector<std::string> names;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--sizes" && i + 1 < argc)
+      sizes = parse_sizes(argv[++i]);
+    else if (arg == "--solver-max" && i + 1 < argc)
+      solver_max = std::atoi(argv[++i]);
+    else if (arg == "--min-time" && i + 1 < argc)
+      min_time = std::atof(argv[++i]);
+    else if (arg == "--list") {
+      for (const kernel_t &kernel : KERNELS)
+        std::cout << kernel.name << (kernel.logical ? " (logical)" : "")
+                  << std::endl;
+      return 0;
+    } else if (arg == "--help") {
+      print_usage(std::cout);
+      return 0;
+    } else if (arg.empty() || arg[0] == '-') {
+      print_usage(std::cerr);
+      return 1;
+    } else
+      names.push_back(arg);
+  }
+
+  for (int size : sizes)
+    if (size <= 0 || size % 4 != 0) {
+      std::cerr << "invalid size: " << size << std::endl;
+      return 1;
+    }
+
+  for (const std::string &name : names)
+    if (std::none_of(KERNELS.begin(), KERNELS.end(),
+                     [&name](const kernel_t &kernel) {
+                       return name == kernel.name;
+                     })) {
+      std::cerr << "unknown kernel: " << name << std::endl;
+      return 1;
+    }
+
+  bool first = true;
+  std::cout << "{\"kernels\": [";
+  for (const kernel_t &kernel : KERNELS) {
+    if (!names.empty() &&
+        std::find(names.begin(), names.end(), kernel.name) == names.end())
+      continue;
+
+    for (bool use_solver : {false, true}) {
+      if (use_solver && !kernel.logical)
+        continue;
+
+      for (int size : sizes) {
+        if (use_solver && size > solver_max)
+          continue;
+
+        measurement_t m = measure(kernel, size, use_solver, min_time);
+        double nanos = 1e9 * m.seconds / m.iterations;
+
+        std::cout << (first ? "\n" : ",\n");
+        first = false;
+        std::cout << "{\"name\": \"" << kernel.name << "\", \"logic\": \""
+                  << (use_solver ? "solver" : "boolean")
+                  << "\", \"shape\": [" << size << ", " << size
+                  << "], \"elements\": " << m.elements
+                  << ", \"iterations\": " << m.iterations
+                  << ", \"ns_per_op\": " << nanos
+                  << ", \"ns_per_element\": " << nanos / m.elements
+                  << ", \"bytes_per_op\": "
+                  << double(m.bytes) / m.iterations
+                  << ", \"allocations_per_op\": "
+                  << double(m.allocations) / m.iterations << "}";
+        std::cout.flush();
+      }
+    }
+  }
+  std::cout << "\n]}" << std::endl;
+
+  return 0;
+}
@@ -20,11 +20,17 @@
  * IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <sstream>
+#include <string>
 
+#include "uasat/clone.hpp"
 #include "uasat/group.hpp"
+#include "uasat/set.hpp"
 #include "uasat/shape.hpp"
+#include "uasat/symmetry.hpp"
 #include "uasat/tensor.hpp"
 
 void test_group() {
@@ -66,8 +72,210 @@ void test_shape() {
   std::cout << s2 << " " << s2.length() << " " << s2.extent() << std::endl;
 }
 
+void test_amo_encoding(const char *name, uasat::Logic::amo_encoding_t encoding,
+                       int size) {
+  auto start = std::chrono::steady_clock::now();
+
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create();
+  solver->set_amo_encoding(encoding);
+  uasat::SymmetricGroup group(size);
+  uasat::Tensor perm = uasat::Tensor::variable(solver, group.get_shape());
+  solver->add_clause(group.contains(perm).get_scalar());
+  uasat::Operations ops(size);
+  uasat::Tensor op = uasat::Tensor::variable(solver, ops.get_shape(2));
+  solver->add_clause(ops.contains(2, op).get_scalar());
+  bool solvable = solver->solve();
+
+  int msecs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+
+  std::cout << name << " size " << size << ": vars "
+            << solver->get_variables() << " clauses " << solver->get_clauses()
+            << " solvable " << solvable << " time " << msecs << " ms"
+            << std::endl;
+}
+
+void test_amo() {
+  for (int size : {8, 16, 32}) {
+    test_amo_encoding("pairwise", uasat::Logic::AMO_PAIRWISE, size);
+    test_amo_encoding("ladder", uasat::Logic::AMO_LADDER, size);
+    test_amo_encoding("commander", uasat::Logic::AMO_COMMANDER, size);
+    test_amo_encoding("product", uasat::Logic::AMO_PRODUCT, size);
+    test_amo_encoding("bimander", uasat::Logic::AMO_BIMANDER, size);
+  }
+}
+
+void test_hashing_after_elimination(const char *options) {
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create(options);
+  solver->set_hashing(true);
+  uasat::Tensor elems = uasat::Tensor::variable(solver, {4});
+  solver->add_clause(elems.fold_any().get_scalar());
+  bool solvable1 = solver->solve();
+
+  // the output of the first fold is eliminated, so it must be rebuilt
+  solver->add_clause(solver->logic_not(elems.fold_any().get_scalar()));
+  bool solvable2 = solver->solve();
+
+  std::cout << options << " hashing after elimination: "
+            << (solvable1 && !solvable2 ? "ok" : "FAILED") << std::endl;
+}
+
+void test_polarity_after_elimination(const char *options) {
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create(options);
+  solver->set_polarity_gates(true);
+  uasat::Tensor elems = uasat::Tensor::variable(solver, {2});
+  uasat::literal_t both = elems.fold_all().get_scalar();
+  solver->add_clause(both);
+  bool solvable1 = solver->solve();
+
+  // requires the other half of the definition, which is still pending
+  solver->add_clause(solver->logic_not(both));
+  bool solvable2 = solver->solve();
+
+  std::cout << options << " polarity after elimination: "
+            << (solvable1 && !solvable2 ? "ok" : "FAILED") << std::endl;
+}
+
+class EquivalenceRelations : public uasat::AbstractSet {
+protected:
+  int size;
+
+public:
+  EquivalenceRelations(int size) : AbstractSet({size, size}), size(size) {}
+
+  uasat::Tensor contains(const uasat::Tensor &rel) override {
+    uasat::Tensor reflexive = rel.polymer({size}, {0, 0}).fold_all();
+    uasat::Tensor symmetric = rel.logic_leq(rel.polymer({size, size}, {1, 0}))
+                                  .fold_all()
+                                  .fold_all();
+    uasat::Tensor transitive =
+        rel.contract({size, size, size}, {1, 0}, rel, {0, 2})
+            .logic_leq(rel)
+            .fold_all()
+            .fold_all();
+    return reflexive.logic_and(symmetric).logic_and(transitive);
+  }
+};
+
+void test_symmetry() {
+  // there are 52 equivalence relations on 5 elements in 7 orbits
+  EquivalenceRelations rels(5);
+  uasat::Symmetry complete(5, {0, 1}, uasat::Symmetry::COMPLETE);
+  uasat::Symmetry transpositions(5, {0, 1}, uasat::Symmetry::TRANSPOSITIONS);
+  uasat::Symmetry adjacent(5, {0, 1});
+
+  int count1 = rels.find_cardinality();
+  int count2 = rels.find_cardinality(&complete);
+  int count3 = rels.find_cardinality(&transpositions);
+  int count4 = rels.find_cardinality(&adjacent);
+
+  std::cout << "symmetry: " << count1 << " " << count2 << " " << count3 << " "
+            << count4 << " "
+            << (count1 == 52 && count2 == 7 && 7 <= count3 && count3 <= 52 &&
+                        count3 <= count4 && count4 <= 52
+                    ? "ok"
+                    : "FAILED")
+            << std::endl;
+}
+
+std::string print_tensor(const uasat::Tensor &tensor) {
+  std::ostringstream out;
+  out << tensor;
+  return out.str();
+}
+
+std::vector<std::string> print_elements(const uasat::Tensor &elems) {
+  std::vector<std::string> result;
+  for (const uasat::Tensor &elem : elems.slices())
+    result.push_back(print_tensor(elem));
+  return result;
+}
+
+void test_parallel() {
+  // the first group has fewer literals than cubes wanted for 32 threads
+  uasat::SymmetricGroup group1(2);
+  uasat::SymmetricGroup group2(4);
+  bool ok = true;
+
+  for (uasat::AbstractSet *set : {&group1, &group2}) {
+    int count = set->find_cardinality();
+    std::vector<std::string> elems = print_elements(set->find_elements());
+    std::sort(elems.begin(), elems.end());
+
+    std::vector<std::string> first;
+    for (int threads : {1, 2, 3, 8, 32}) {
+      ok = ok && set->find_cardinality_parallel(threads) == count;
+
+      // sorted by the packed values, so only the printouts are reordered
+      std::vector<std::string> elems2 =
+          print_elements(set->find_elements_parallel(threads));
+      if (first.empty())
+        first = elems2;
+      ok = ok && elems2 == first;
+
+      std::sort(elems2.begin(), elems2.end());
+      ok = ok && elems2 == elems;
+    }
+  }
+
+  std::cout << "parallel enumeration: " << (ok ? "ok" : "FAILED")
+            << std::endl;
+}
+
+uasat::Tensor wrap_constants(const std::shared_ptr<uasat::Solver> &solver,
+                             const uasat::Tensor &tensor) {
+  const std::vector<int> &shape = tensor.get_shape();
+  uasat::Tensor zero = uasat::Tensor::constant(shape, false);
+  return tensor.logic_or(
+      zero.logic_and(uasat::Tensor::variable(solver, shape)));
+}
+
+void test_packed() {
+  // the packed boolean kernels must agree with the generic operations,
+  // which are used when the same constants are wrapped in solver tensors
+  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create();
+  uasat::Tensor a = uasat::Tensor::lessthan(9).logic_add(
+      uasat::Tensor::diagonal(9).permute({0}, {1, 2, 3, 4, 5, 6, 7, 8, 0}));
+  uasat::Tensor b = uasat::Tensor::lessthan(9).polymer({9, 9}, {1, 0});
+  uasat::Tensor a2 = wrap_constants(solver, a);
+  uasat::Tensor b2 = wrap_constants(solver, b);
+
+  std::vector<std::pair<uasat::Tensor, uasat::Tensor>> pairs = {
+      {a.logic_and(b), a2.logic_and(b2)},
+      {a.logic_leq(b), a2.logic_leq(b2)},
+      {a.logic_equ(b), a2.logic_equ(b2)},
+      {a.logic_maj(b, a.logic_not()), a2.logic_maj(b2, a2.logic_not())},
+      {a.fold_sum(), a2.fold_sum()},
+      {a.fold_exactly(2), a2.fold_exactly(2)},
+      {a.fold_one(), a2.fold_one()},
+      {b.polymer({9, 9}, {1, 0}).fold_any(),
+       b2.polymer({9, 9}, {1, 0}).fold_any()},
+      {uasat::Tensor::stack(a.slices()), uasat::Tensor::stack(a2.slices())},
+      {a.contract({9, 9, 9}, {1, 0}, b, {0, 2}),
+       a2.contract({9, 9, 9}, {1, 0}, b2, {0, 2})},
+      {a.lex_leq(b), a2.lex_leq(b2)},
+  };
+
+  bool ok = true;
+  for (const auto &pair : pairs)
+    ok = ok && pair.first.get_logic() == uasat::BOOLEAN &&
+         print_tensor(pair.first) == print_tensor(pair.second);
+
+  std::cout << "packed boolean tensors: " << (ok ? "ok" : "FAILED")
+            << std::endl;
+}
+
 int main() {
   // test_binarynum();
+  // test_amo();
   test_shape();
+  test_hashing_after_elimination("minisatsimp");
+  test_hashing_after_elimination("portfolio");
+  test_polarity_after_elimination("minisatsimp");
+  test_polarity_after_elimination("portfolio");
+  test_packed();
+  test_symmetry();
+  test_parallel();
   return 0;
 }
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "bell.hpp"
+#include "uasat/tensor.hpp"
+
+long count_equivalences_clauses(const std::shared_ptr<uasat::Solver> &solver,
+                                int size) {
+  // create binary relation
+  std::vector<uasat::literal_t> table(size * size);
+  for (size_t i = 0; i < table.size(); i++)
+    table[i] = solver->add_variable();
+
+  // reflexive
+  for (int i = 0; i < size; i++)
+    solver->add_clause(table[i * (size + 1)]);
+
+  // symmetric
+  for (int i = 0; i < size; i++)
+    for (int j = 0; j < size; j++)
+      solver->add_clause(table[i * size + j],
+                         solver->logic_not(table[j * size + i]));
+
+  // transitive
+  for (int i = 0; i < size; i++)
+    for (int j = 0; j < size; j++)
+      for (int k = 0; k < size; k++)
+        solver->add_clause(solver->logic_not(table[i * size + j]),
+                           solver->logic_not(table[j * size + k]),
+                           table[i * size + k]);
+
+  std::vector<uasat::literal_t> clause(size * size);
+  long count = 0;
+  while (solver->solve()) {
+    count += 1;
+    for (size_t i = 0; i < table.size(); i++) {
+      uasat::literal_t b = solver->get_solution(table[i]);
+      clause[i] = b == solver->TRUE ? solver->logic_not(table[i]) : table[i];
+    }
+    solver->add_clause(clause);
+  }
+
+  return count;
+}
+
+long count_equivalences_tensors(const std::shared_ptr<uasat::Solver> &solver,
+                                int size) {
+  solver->set_hashing(true);
+  solver->set_polarity_gates(true);
+
+  uasat::Tensor relation = uasat::Tensor::variable(solver, {size, size});
+
+  uasat::Tensor reflexive = relation.polymer({size}, {0, 0}).fold_all();
+
+  uasat::Tensor symmetric =
+      relation.logic_leq(relation.polymer({size, size}, {1, 0}))
+          .fold_all()
+          .fold_all();
+
+  uasat::Tensor transitive =
+      relation.contract({size, size, size}, {1, 0}, relation, {0, 2})
+          .logic_leq(relation)
+          .fold_all()
+          .fold_all();
+
+  uasat::Tensor equivalence =
+      reflexive.logic_and(symmetric).logic_and(transitive);
+  solver->add_clause(equivalence.get_scalar());
+
+  std::vector<uasat::literal_t> projection;
+  relation.extend_clause(projection);
+
+  return solver->enumerate(projection,
+                           [](const uasat::bitvec_t *) { return true; });
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#ifndef VALIDATE_BELL_HPP
+#define VALIDATE_BELL_HPP
+
+#include <memory>
+
+#include "uasat/solver.hpp"
+
+/**
+ * Counts the equivalence relations on a set of the given size by adding
+ * their clauses directly to the solver and blocking each solution found.
+ */
+long count_equivalences_clauses(const std::shared_ptr<uasat::Solver> &solver,
+                                int size);
+
+/**
+ * Counts the equivalence relations on a set of the given size by building
+ * the relation axioms from tensors and enumerating the solutions. This turns
+ * on hashing and polarity gates in the solver.
+ */
+long count_equivalences_tensors(const std::shared_ptr<uasat::Solver> &solver,
+                                int size);
+
+#endif // VALIDATE_BELL_HPP
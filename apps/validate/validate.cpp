@@ -23,82 +23,15 @@
 #include <chrono>
 #include <iostream>
 
-#include "uasat/solver.hpp"
-#include "uasat/tensor.hpp"
+#include "bell.hpp"
 
 int validate1(int size) {
-  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create("minisat");
-
-  // create binary relation
-  std::vector<uasat::literal_t> table(size * size);
-  for (size_t i = 0; i < table.size(); i++)
-    table[i] = solver->add_variable();
-
-  // reflexive
-  for (int i = 0; i < size; i++)
-    solver->add_clause(table[i * (size + 1)]);
-
-  // symmetric
-  for (int i = 0; i < size; i++)
-    for (int j = 0; j < size; j++)
-      solver->add_clause(table[i * size + j],
-                         solver->logic_not(table[j * size + i]));
-
-  // transitive
-  for (int i = 0; i < size; i++)
-    for (int j = 0; j < size; j++)
-      for (int k = 0; k < size; k++)
-        solver->add_clause(solver->logic_not(table[i * size + j]),
-                           solver->logic_not(table[j * size + k]),
-                           table[i * size + k]);
-
-  std::vector<uasat::literal_t> clause(size * size);
-  int count = 0;
-  while (solver->solve()) {
-    count += 1;
-    for (size_t i = 0; i < table.size(); i++) {
-      uasat::literal_t b = solver->get_solution(table[i]);
-      clause[i] = b == solver->TRUE ? solver->logic_not(table[i]) : table[i];
-    }
-    solver->add_clause(clause);
-  }
-
-  return count;
+  return count_equivalences_clauses(uasat::Solver::create("minisat"), size);
 }
 
 int validate2(int size) {
-  std::shared_ptr<uasat::Solver> solver = uasat::Solver::create("minisatsimp");
-
-  uasat::Tensor relation = uasat::Tensor::variable(solver, {size, size});
-
-  uasat::Tensor reflexive = relation.polymer({size}, {0, 0}).fold_all();
-
-  uasat::Tensor symmetric =
-      relation.logic_leq(relation.polymer({size, size}, {1, 0}))
-          .fold_all()
-          .fold_all();
-
-  uasat::Tensor transitive =
-      relation.polymer({size, size, size}, {1, 0})
-          .logic_and(relation.polymer({size, size, size}, {0, 2}))
-          .fold_any()
-          .logic_leq(relation)
-          .fold_all()
-          .fold_all();
-
-  uasat::Tensor equivalence =
-      reflexive.logic_and(symmetric).logic_and(transitive);
-  solver->add_clause(equivalence.get_scalar());
-
-  int count = 0;
-  while (solver->solve()) {
-    std::vector<uasat::literal_t> clause;
-    relation.logic_add(relation.get_solution(solver)).extend_clause(clause);
-    solver->add_clause(clause);
-    count += 1;
-  }
-
-  return count;
+  return count_equivalences_tensors(uasat::Solver::create("minisatsimp"),
+                                    size);
 }
 
 int main() {
@@ -70,18 +70,217 @@ public:
   /**
    * Copies the data from source to destination whose lengths must match.
    */
-  static void copy(bitvec_t *dst, bitvec_t *src) {
+  static void copy(bitvec_t *dst, const bitvec_t *src) {
     assert(dst->length == src->length);
     std::memcpy(dst->data, src->data, (dst->length + 7) / 8);
   }
 
-  static void negate(bitvec_t *dst, bitvec_t *src) {
+  static void negate(bitvec_t *dst, const bitvec_t *src) {
     assert(dst->length == src->length);
 
     uint64_t blocks = (dst->length + 63) / 64;
     for (uint64_t i = 0; i < blocks; i++)
       dst->data[i] = ~(src->data[i]);
   }
+
+  /**
+   * Returns the length of the vector in bits.
+   */
+  static uint64_t get_length(const bitvec_t *vec) { return vec->length; }
+
+  /**
+   * Returns the bit at the given position.
+   */
+  static bool get_bit(const bitvec_t *vec, uint64_t pos) {
+    assert(pos < vec->length);
+    return ((vec->data[pos / 64] >> (pos % 64)) & 1) != 0;
+  }
+
+  /**
+   * Sets the bit at the given position to the given value.
+   */
+  static void set_bit(bitvec_t *vec, uint64_t pos, bool value) {
+    assert(pos < vec->length);
+    uint64_t mask = uint64_t(1) << (pos % 64);
+    if (value)
+      vec->data[pos / 64] |= mask;
+    else
+      vec->data[pos / 64] &= ~mask;
+  }
+
+  /**
+   * Sets the 64 bits of the given block, which holds the bits from position
+   * 64 * block. The bits beyond the length of the vector are ignored.
+   */
+  static void set_block(bitvec_t *vec, uint64_t block, uint64_t value) {
+    assert(block < (vec->length + 63) / 64);
+    vec->data[block] = value;
+  }
+
+  /**
+   * Sets all bits of the vector to the given value.
+   */
+  static void fill(bitvec_t *vec, bool value) {
+    std::memset(vec->data, value ? 0xff : 0x00, 8 * ((vec->length + 63) / 64));
+  }
+
+  /**
+   * Stores the bitwise and of the two sources in the destination. The
+   * lengths must match, the destination can be one of the sources.
+   */
+  static void logic_and(bitvec_t *dst, const bitvec_t *src1,
+                        const bitvec_t *src2) {
+    assert(dst->length == src1->length && dst->length == src2->length);
+
+    uint64_t blocks = (dst->length + 63) / 64;
+    for (uint64_t i = 0; i < blocks; i++)
+      dst->data[i] = src1->data[i] & src2->data[i];
+  }
+
+  /**
+   * Stores the bitwise or of the two sources in the destination.
+   */
+  static void logic_or(bitvec_t *dst, const bitvec_t *src1,
+                       const bitvec_t *src2) {
+    assert(dst->length == src1->length && dst->length == src2->length);
+
+    uint64_t blocks = (dst->length + 63) / 64;
+    for (uint64_t i = 0; i < blocks; i++)
+      dst->data[i] = src1->data[i] | src2->data[i];
+  }
+
+  /**
+   * Stores the bitwise implication of the two sources in the destination.
+   */
+  static void logic_leq(bitvec_t *dst, const bitvec_t *src1,
+                        const bitvec_t *src2) {
+    assert(dst->length == src1->length && dst->length == src2->length);
+
+    uint64_t blocks = (dst->length + 63) / 64;
+    for (uint64_t i = 0; i < blocks; i++)
+      dst->data[i] = ~src1->data[i] | src2->data[i];
+  }
+
+  /**
+   * Stores the bitwise xor of the two sources in the destination.
+   */
+  static void logic_add(bitvec_t *dst, const bitvec_t *src1,
+                        const bitvec_t *src2) {
+    assert(dst->length == src1->length && dst->length == src2->length);
+
+    uint64_t blocks = (dst->length + 63) / 64;
+    for (uint64_t i = 0; i < blocks; i++)
+      dst->data[i] = src1->data[i] ^ src2->data[i];
+  }
+
+  /**
+   * Stores the bitwise equivalence of the two sources in the destination.
+   */
+  static void logic_equ(bitvec_t *dst, const bitvec_t *src1,
+                        const bitvec_t *src2) {
+    assert(dst->length == src1->length && dst->length == src2->length);
+
+    uint64_t blocks = (dst->length + 63) / 64;
+    for (uint64_t i = 0; i < blocks; i++)
+      dst->data[i] = ~(src1->data[i] ^ src2->data[i]);
+  }
+
+  /**
+   * Stores the bitwise majority of the three sources in the destination.
+   */
+  static void logic_maj(bitvec_t *dst, const bitvec_t *src1,
+                        const bitvec_t *src2, const bitvec_t *src3) {
+    assert(dst->length == src1->length && dst->length == src2->length &&
+           dst->length == src3->length);
+
+    uint64_t blocks = (dst->length + 63) / 64;
+    for (uint64_t i = 0; i < blocks; i++)
+      dst->data[i] = (src1->data[i] & src2->data[i]) |
+                     (src3->data[i] & (src1->data[i] | src2->data[i]));
+  }
+
+  /**
+   * Stores the second source where the first one is set and the third one
+   * elsewhere in the destination.
+   */
+  static void logic_iff(bitvec_t *dst, const bitvec_t *src1,
+                        const bitvec_t *src2, const bitvec_t *src3) {
+    assert(dst->length == src1->length && dst->length == src2->length &&
+           dst->length == src3->length);
+
+    uint64_t blocks = (dst->length + 63) / 64;
+    for (uint64_t i = 0; i < blocks; i++)
+      dst->data[i] = (src1->data[i] & src2->data[i]) |
+                     (~src1->data[i] & src3->data[i]);
+  }
+
+  /**
+   * Returns the number of bits set among the given number of bits starting
+   * at the given position.
+   */
+  static uint64_t count(const bitvec_t *vec, uint64_t pos, uint64_t length) {
+    assert(pos <= vec->length && length <= vec->length - pos);
+
+    uint64_t result = 0;
+    while (length > 0) {
+      uint64_t shift = pos % 64;
+      uint64_t bits = 64 - shift < length ? 64 - shift : length;
+      uint64_t word = vec->data[pos / 64] >> shift;
+      if (bits < 64)
+        word &= (uint64_t(1) << bits) - 1;
+      result += popcount(word);
+      pos += bits;
+      length -= bits;
+    }
+    return result;
+  }
+
+  /**
+   * Returns the first position where the two vectors of the same length
+   * differ, or the length if they are equal.
+   */
+  static uint64_t find_difference(const bitvec_t *vec1,
+                                  const bitvec_t *vec2) {
+    assert(vec1->length == vec2->length);
+
+    uint64_t blocks = (vec1->length + 63) / 64;
+    for (uint64_t i = 0; i < blocks; i++) {
+      uint64_t word = vec1->data[i] ^ vec2->data[i];
+      if (word != 0) {
+        // the unused bits of the last block are undefined
+        uint64_t pos = 64 * i + popcount((word & (~word + 1)) - 1);
+        return pos < vec1->length ? pos : vec1->length;
+      }
+    }
+    return vec1->length;
+  }
+
+  /**
+   * Returns true if the first vector is smaller than the second one of the
+   * same length in a fixed total order, which is useful for sorting.
+   */
+  static bool less(const bitvec_t *vec1, const bitvec_t *vec2) {
+    assert(vec1->length == vec2->length);
+
+    uint64_t blocks = vec1->length / 64;
+    for (uint64_t i = 0; i < blocks; i++)
+      if (vec1->data[i] != vec2->data[i])
+        return vec1->data[i] < vec2->data[i];
+
+    if (vec1->length % 64 != 0) {
+      uint64_t mask = (uint64_t(1) << (vec1->length % 64)) - 1;
+      return (vec1->data[blocks] & mask) < (vec2->data[blocks] & mask);
+    }
+    return false;
+  }
+
+private:
+  static uint64_t popcount(uint64_t word) {
+    word = word - ((word >> 1) & 0x5555555555555555);
+    word = (word & 0x3333333333333333) + ((word >> 2) & 0x3333333333333333);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0f;
+    return (word * 0x0101010101010101) >> 56;
+  }
 };
 
 } // namespace uasat
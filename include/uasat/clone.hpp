@@ -20,8 +20,8 @@
  * IN THE SOFTWARE.
  */
 
-#ifndef UASAT_GROUP_HPP
-#define UASAT_GROUP_HPP
+#ifndef UASAT_CLONE_HPP
+#define UASAT_CLONE_HPP
 
 #include "uasat/set.hpp"
 
@@ -80,4 +80,4 @@ public:
 
 } // namespace uasat
 
-#endif // UASAT_GROUP_HPP
+#endif // UASAT_CLONE_HPP
@@ -24,9 +24,12 @@
 #define UASAT_GROUP_HPP
 
 #include "set.hpp"
+#include <memory>
 
 namespace uasat {
 
+class Profiler;
+
 class AbstractGroup : public AbstractSet {
 public:
   /**
@@ -51,9 +54,10 @@ public:
 
   /**
    * Tests that the underlying set is closed under the operations and the
-   * operations satisfy the group axioms.
+   * operations satisfy the group axioms. The encoding of each axiom is
+   * reported to the profiler if one is given.
    */
-  void test_axioms();
+  void test_axioms(const std::shared_ptr<Profiler> &profiler = nullptr);
 };
 
 class SymmetricGroup : public AbstractGroup {
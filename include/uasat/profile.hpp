@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UASAT_PROFILE_HPP
+#define UASAT_PROFILE_HPP
+
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uasat {
+
+class Logic;
+
+class Profiler {
+protected:
+  /**
+   * A node of the call tree with the totals of all calls with the same tag
+   * stack, including the nested sections.
+   */
+  struct node_t {
+    std::string tag;
+    unsigned long calls = 0;
+    unsigned long variables = 0;
+    unsigned long clauses = 0;
+    double time = 0.0;
+    std::vector<std::unique_ptr<node_t>> children;
+  };
+
+  struct frame_t {
+    node_t *node;
+    unsigned long variables;
+    unsigned long clauses;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  node_t root;
+  std::vector<frame_t> stack;
+
+  void print(std::ostream &out, const node_t &node, int depth) const;
+  void print_json(std::ostream &out, const node_t &node) const;
+
+public:
+  /**
+   * Enters a section with the given tag, where the counters are the current
+   * number of variables and encoded clauses of the solver.
+   */
+  void push(const char *tag, unsigned long variables, unsigned long clauses);
+
+  /**
+   * Leaves the innermost section and attributes the variables and clauses
+   * created since it was entered to it. Does nothing if the innermost
+   * section has a different tag. Counters that went down count as zero.
+   */
+  void pop(const char *tag, unsigned long variables, unsigned long clauses);
+
+  /**
+   * Forgets all collected data, must not be called while a section is open.
+   */
+  void clear();
+
+  /**
+   * Prints out the call tree as an indented table with the total and the
+   * self (not in a nested section) counts of each tag.
+   */
+  void print(std::ostream &out) const;
+
+  /**
+   * Prints out the call tree as nested JSON objects.
+   */
+  void print_json(std::ostream &out) const;
+};
+
+/**
+ * Marks the lifetime of this object as a profiled section of the encoding
+ * with the given tag. It does nothing unless the logic is a solver with a
+ * profiler.
+ */
+class ProfileScope {
+protected:
+  Logic &logic;
+  const char *tag;
+
+public:
+  ProfileScope(Logic &logic, const char *tag);
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+} // namespace uasat
+
+#endif // UASAT_PROFILE_HPP
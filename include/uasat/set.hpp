@@ -23,11 +23,13 @@
 #ifndef UASAT_SET_HPP
 #define UASAT_SET_HPP
 
+#include <functional>
 #include <vector>
 
 namespace uasat {
 
 class Tensor;
+class Symmetry;
 
 class AbstractSet {
 protected:
@@ -63,15 +65,42 @@ public:
   Tensor equals(const Tensor &elem1, const Tensor &elem2);
 
   /**
-   * Calculates all elements of this set and puts them into a single tensor
-   * whose first axis is the element index.
+   * Calls the callback with each element of this set as soon as it is found,
+   * and stops early if the callback returns false. Returns the number of
+   * elements visited. If a symmetry is given, then only the lex-leaders of
+   * the orbits are visited, which enumerates the elements up to isomorphism.
    */
-  Tensor find_elements();
+  unsigned long
+  for_each_element(const std::function<bool(const Tensor &elem)> &callback,
+                   const Symmetry *symmetry = nullptr);
 
   /**
-   * Returns the cardinality of this set.
+   * Calculates all elements of this set (up to the optional symmetry) and puts
+   * them into a single tensor whose first axis is the element index.
    */
-  int find_cardinality();
+  Tensor find_elements(const Symmetry *symmetry = nullptr);
+
+  /**
+   * Returns the cardinality of this set (up to the optional symmetry), without
+   * storing the elements.
+   */
+  int find_cardinality(const Symmetry *symmetry = nullptr);
+
+  /**
+   * Calculates the same elements as find_elements, but splits the search into
+   * cubes over the first literals of the element that are enumerated by the
+   * given number of worker threads (all cores if not positive), each with its
+   * own copy of the encoding. The elements are sorted, so the result does not
+   * depend on the number of threads or on the scheduling.
+   */
+  Tensor find_elements_parallel(int threads,
+                                const Symmetry *symmetry = nullptr);
+
+  /**
+   * Returns the cardinality of this set counted by parallel workers.
+   */
+  int find_cardinality_parallel(int threads,
+                                const Symmetry *symmetry = nullptr);
 };
 
 class GradedSet {
@@ -96,15 +125,41 @@ public:
   Tensor equals(int grade, const Tensor &elem1, const Tensor &elem2);
 
   /**
-   * Calculates all elements of this graded set and puts them into a single
-   * tensor whose first axis is the element index.
+   * Calls the callback with each element of the given grade as soon as it is
+   * found, and stops early if the callback returns false. Returns the number
+   * of elements visited. If a symmetry is given, then only the lex-leaders of
+   * the orbits are visited.
+   */
+  unsigned long
+  for_each_element(int grade,
+                   const std::function<bool(const Tensor &elem)> &callback,
+                   const Symmetry *symmetry = nullptr);
+
+  /**
+   * Calculates all elements of this graded set (up to the optional symmetry)
+   * and puts them into a single tensor whose first axis is the element index.
+   */
+  Tensor find_elements(int grade, const Symmetry *symmetry = nullptr);
+
+  /**
+   * Returns the cardinality of this graded set at the given grade (up to the
+   * optional symmetry), without storing the elements.
+   */
+  int find_cardinality(int grade, const Symmetry *symmetry = nullptr);
+
+  /**
+   * Calculates the same elements as find_elements at the given grade with the
+   * given number of worker threads, see AbstractSet::find_elements_parallel.
    */
-  Tensor find_elements(int grade);
+  Tensor find_elements_parallel(int grade, int threads,
+                                const Symmetry *symmetry = nullptr);
 
   /**
-   * Returns the cardinality of this graded set at the given grade.
+   * Returns the cardinality of this graded set at the given grade counted by
+   * parallel workers.
    */
-  int find_cardinality(int grade);
+  int find_cardinality_parallel(int grade, int threads,
+                                const Symmetry *symmetry = nullptr);
 };
 
 } // namespace uasat
@@ -23,8 +23,16 @@
 #ifndef UASAT_SOLVER_HPP
 #define UASAT_SOLVER_HPP
 
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <initializer_list>
+#include <iosfwd>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace uasat {
@@ -37,6 +45,22 @@ public:
   static const literal_t UNDEF = 0;
   static const literal_t FALSE = -1;
 
+  /**
+   * The encodings of the at most one constraint: pairwise comparisons, a
+   * ladder of prefix ors, groups of three with commander literals, a two
+   * dimensional product of row and column ors, and bimander (pairs with a
+   * binary encoding of the pair index). The default one is selected by the
+   * solver.
+   */
+  enum amo_encoding_t {
+    AMO_DEFAULT,
+    AMO_PAIRWISE,
+    AMO_LADDER,
+    AMO_COMMANDER,
+    AMO_PRODUCT,
+    AMO_BIMANDER
+  };
+
 public:
   virtual ~Logic() = default;
 
@@ -62,19 +86,400 @@ public:
 
   virtual literal_t logic_iff(literal_t lit1, literal_t lit2, literal_t lit3);
 
+  /**
+   * Returns the logical and of the given literals, which is TRUE for the empty
+   * list.
+   */
+  virtual literal_t logic_all(const std::vector<literal_t> &lits);
+
+  /**
+   * Returns the logical or of the given literals, which is FALSE for the empty
+   * list.
+   */
+  virtual literal_t logic_any(const std::vector<literal_t> &lits);
+
+  /**
+   * Returns the logical sum of the given literals, which is FALSE for the empty
+   * list.
+   */
+  virtual literal_t logic_sum(const std::vector<literal_t> &lits);
+
+  /**
+   * Returns true if at least k of the given literals are true.
+   */
+  virtual literal_t logic_atleast(const std::vector<literal_t> &lits, int k);
+
+  /**
+   * Returns true if at most k of the given literals are true.
+   */
+  literal_t logic_atmost(const std::vector<literal_t> &lits, int k) {
+    return logic_not(logic_atleast(lits, k + 1));
+  }
+
+  /**
+   * Returns true if exactly k of the given literals are true.
+   */
+  virtual literal_t logic_exactly(const std::vector<literal_t> &lits, int k);
+
+  /**
+   * Returns true if at most one of the given literals is true, encoded with
+   * the given encoding.
+   */
+  virtual literal_t logic_amo(const std::vector<literal_t> &lits,
+                              amo_encoding_t encoding);
+
+  /**
+   * Returns true if exactly one of the given literals is true.
+   */
+  literal_t logic_one(const std::vector<literal_t> &lits,
+                      amo_encoding_t encoding) {
+    return logic_and(logic_any(lits), logic_amo(lits, encoding));
+  }
+
   /**
    * Checks if the two logics are compatible, that is they are
    * either equals or one of them is the BOOLEAN one.
    */
   static std::shared_ptr<Logic> join(const std::shared_ptr<Logic> &logic1,
                                      const std::shared_ptr<Logic> &logic2);
+
+  /**
+   * Enters and leaves a profiled section of the encoding with the given tag,
+   * see ProfileScope. They do nothing by default.
+   */
+  virtual void profile_push(const char *) {}
+  virtual void profile_pop(const char *) {}
 };
 
 extern const std::shared_ptr<Logic> BOOLEAN;
 
 class Tensor;
+class Profiler;
+struct bitvec_t;
 
 class Solver : public Logic {
+public:
+  /**
+   * The clause encodings of the cardinality constraints: the sequential
+   * counter uses O(nk) clauses, the totalizer O(nk) clauses but only O(log n)
+   * depth, and the odd-even merge sorting network O(n log^2 n) clauses.
+   */
+  enum card_encoding_t { CARD_SEQUENTIAL, CARD_TOTALIZER, CARD_NETWORK };
+
+  /**
+   * The outcome of a solve call, which is unknown if the budget is exhausted
+   * or the call is interrupted.
+   */
+  enum result_t { RESULT_UNSAT, RESULT_SAT, RESULT_UNKNOWN };
+
+  /**
+   * The limits of a single solve call on the number of conflicts, the number
+   * of propagations and the wall clock time in seconds. Negative values mean
+   * no limit.
+   */
+  struct budget_t {
+    long conflicts;
+    long propagations;
+    double seconds;
+
+    budget_t(long conflicts = -1, long propagations = -1, double seconds = -1)
+        : conflicts(conflicts), propagations(propagations), seconds(seconds) {}
+  };
+
+  /**
+   * The kinds of logic operations whose encoding is counted separately. The
+   * gates built inside an operation are attributed to the outermost one.
+   */
+  enum stats_op_t {
+    OP_AND,
+    OP_ADD,
+    OP_MAJ,
+    OP_NARY,
+    OP_SUM,
+    OP_CARD,
+    OP_AMO,
+    OP_COUNT
+  };
+
+  /**
+   * The number of outermost calls of an operation kind that had to encode
+   * something, and the variables and clauses these calls created. Calls
+   * answered by constant folding or by the structural hash are not counted.
+   */
+  struct op_stats_t {
+    unsigned long calls = 0;
+    unsigned long variables = 0;
+    unsigned long clauses = 0;
+  };
+
+  /**
+   * Statistics of the search and of the encoding since the solver was created
+   * or cleared. The search counters are summed over all solve calls, the
+   * memory is the peak usage of the process in megabytes (zero if unknown),
+   * and the times are wall clock seconds.
+   */
+  struct stats_t {
+    unsigned long solves = 0;
+    unsigned long conflicts = 0;
+    unsigned long decisions = 0;
+    unsigned long propagations = 0;
+    unsigned long restarts = 0;
+    unsigned long learnts = 0;
+    unsigned long learnt_literals = 0;
+    double memory = 0.0;
+    double solve_time = 0.0;
+    double last_solve_time = 0.0;
+    unsigned long variables = 0;
+    unsigned long clauses = 0;
+    unsigned long encoded_clauses = 0;
+    op_stats_t ops[OP_COUNT];
+  };
+
+  /**
+   * Returns the short lowercase name of the operation kind.
+   */
+  static const char *get_op_name(stats_op_t op);
+
+protected:
+  enum gate_op_t { GATE_AND, GATE_ADD, GATE_MAJ };
+
+  /**
+   * The canonical form of a gate: the inputs are ordered and for the self-dual
+   * operations the polarity of the first input is normalized.
+   */
+  struct gate_t {
+    gate_op_t op;
+    literal_t lit1;
+    literal_t lit2;
+    literal_t lit3;
+
+    bool operator==(const gate_t &other) const {
+      return op == other.op && lit1 == other.lit1 && lit2 == other.lit2 &&
+             lit3 == other.lit3;
+    }
+  };
+
+  struct gate_hash {
+    size_t operator()(const gate_t &gate) const;
+  };
+
+  bool hashing = false;
+  std::unordered_map<gate_t, literal_t, gate_hash> gates;
+  std::map<std::vector<literal_t>, literal_t> nary_gates;
+  unsigned long hash_hits = 0;
+  unsigned long hash_misses = 0;
+
+  /**
+   * Returns the output literal slot of the given canonical gate in the
+   * structural hash table, which is UNDEF if the gate is new. Returns nullptr
+   * if structural hashing is disabled.
+   */
+  literal_t *find_gate(gate_op_t op, literal_t lit1, literal_t lit2,
+                       literal_t lit3 = UNDEF);
+
+  /**
+   * Returns the output literal slot of the n-ary and gate with the given
+   * sorted list of inputs, similarly to the previous method.
+   */
+  literal_t *find_gate(const std::vector<literal_t> &lits);
+
+  /**
+   * Forgets the hashed binary, ternary and n-ary gates, must be called when
+   * their output variables may have been eliminated.
+   */
+  void clear_hashed_gates() {
+    gates.clear();
+    nary_gates.clear();
+  }
+
+  /**
+   * Forgets all hashed gates, must be called when the variables are reset.
+   */
+  void clear_gates();
+
+  bool nary = true;
+  card_encoding_t cardinality = CARD_TOTALIZER;
+  amo_encoding_t amo = AMO_LADDER;
+
+  /**
+   * Returns the logical and of the given literals or of their negations.
+   */
+  literal_t nary_and(const std::vector<literal_t> &lits, bool negate);
+
+  /**
+   * Adds the clause without its FALSE literals, or nothing if it contains
+   * TRUE.
+   */
+  void add_reduced_clause(std::initializer_list<literal_t> lits);
+
+  /**
+   * Returns k literals where the i-th one is true if at least i + 1 of the
+   * given non-constant literals are true, encoded with the selected
+   * cardinality encoding. The number of literals must be at least k.
+   */
+  std::vector<literal_t> count_unary(const std::vector<literal_t> &lits,
+                                     int k);
+
+  std::vector<literal_t> sequential_counter(const std::vector<literal_t> &lits,
+                                            int k);
+  std::vector<literal_t> totalizer(const literal_t *lits, size_t size, int k);
+  std::vector<literal_t> sorting_network(const std::vector<literal_t> &lits,
+                                         int k);
+
+  stats_t stats;
+  stats_op_t active_op = OP_COUNT;
+  std::shared_ptr<Profiler> profiler;
+
+  /**
+   * The profiler (or null) that received each open section, so a section is
+   * left in the same profiler even if another one was attached meanwhile.
+   */
+  std::vector<std::shared_ptr<Profiler>> profiled;
+
+  /**
+   * Attributes the variables and clauses created while it is alive to the
+   * given operation kind, unless an outer operation is already active. It is
+   * created only after the shortcuts, so trivial calls do not pay for it.
+   */
+  class op_scope_t {
+    Solver &solver;
+    bool outer;
+    unsigned long variables;
+    unsigned long clauses;
+
+  public:
+    op_scope_t(Solver &solver, stats_op_t op);
+    ~op_scope_t();
+  };
+
+  /**
+   * The clauses that are not yet passed to the backend, each terminated by a
+   * zero literal, and their number.
+   */
+  std::vector<literal_t> buffer;
+  unsigned long buffered = 0;
+
+  /**
+   * Passes the given zero terminated clauses to the backend.
+   */
+  virtual void push_clauses(const std::vector<literal_t> &clauses) = 0;
+
+  /**
+   * Passes the buffered clauses to the backend, must be called before solving.
+   */
+  void flush_clauses() {
+    if (!buffer.empty()) {
+      push_clauses(buffer);
+      buffer.clear();
+      buffered = 0;
+    }
+  }
+
+  void buffer_clause() {
+    buffer.push_back(0);
+    buffered += 1;
+    stats.encoded_clauses += 1;
+    if (polarity_gates)
+      polarize_clause();
+    if (buffer.size() >= 65536)
+      flush_clauses();
+  }
+
+  /**
+   * The two halves of the definition of a gate output variable in polarity
+   * mode: the positive half contains the clauses with the negated output and
+   * is needed when the output is used positively, and vice versa. Emitted
+   * halves are cleared.
+   */
+  struct definition_t {
+    std::vector<literal_t> positive;
+    std::vector<literal_t> negative;
+    bool positive_emitted = false;
+    bool negative_emitted = false;
+  };
+
+  /**
+   * Emits the definitions required by the assumptions and flushes the
+   * buffered clauses, must be called at the beginning of solve.
+   */
+  void prepare_solve(const std::vector<literal_t> &assumptions) {
+    if (polarity_gates)
+      require_literals(assumptions.data(), assumptions.size());
+    flush_clauses();
+    failed.clear();
+  }
+
+  /**
+   * Solves the problem under the assumptions with the given limits on the
+   * conflicts and propagations of this call, negative values meaning no
+   * limit. This is the entry point implemented by the backends.
+   */
+  virtual result_t solve_limited(const std::vector<literal_t> &assumptions,
+                                 long conflicts, long propagations) = 0;
+
+  /**
+   * Stops the running search of the backend as soon as possible, or the next
+   * one if none is running. Does nothing by default.
+   */
+  virtual void interrupt_search() {}
+
+  /**
+   * Withdraws the interrupt of the backend. Does nothing by default.
+   */
+  virtual void clear_interrupt_search() {}
+
+  /**
+   * Withdraws the interrupt after the search of the backend has finished,
+   * the backends must call this instead of clearing it directly. The
+   * interrupts requested until this point are consumed by that search.
+   */
+  void finish_search();
+
+  /**
+   * The number of interrupts requested by the caller, and the number of
+   * those consumed by a search or withdrawn. The budget timer does not
+   * count, so its interrupt can be withdrawn without losing the others.
+   */
+  std::mutex interrupt_mutex;
+  unsigned long interrupts_requested = 0;
+  unsigned long interrupts_consumed = 0;
+
+  std::vector<literal_t> failed;
+
+  bool polarity_gates = false;
+  std::vector<definition_t> definitions;
+  std::vector<literal_t> required;
+
+  /**
+   * The output literal of the gate whose definition is being added, or UNDEF
+   * if the added clauses are not definitions.
+   */
+  literal_t defining = UNDEF;
+
+  /**
+   * Stores the last buffered clause as a definition half if a gate is being
+   * defined, otherwise emits the definitions of its literals.
+   */
+  void polarize_clause();
+
+  /**
+   * Emits the definition halves required for using the given literals in
+   * clauses, and those required by the emitted clauses, recursively.
+   */
+  void require_literals(const literal_t *lits, size_t size);
+
+  /**
+   * Emits all definition halves that are not yet emitted.
+   */
+  void require_all();
+
+  /**
+   * Returns the variables occurring in the definition halves that are not
+   * yet emitted. A simplifying backend must freeze them before eliminating,
+   * since emitting these halves later adds clauses over them.
+   */
+  std::vector<literal_t> get_pending_variables() const;
+
 public:
   static std::shared_ptr<Solver> create(const std::string &options = "minisat");
   virtual ~Solver() = default;
@@ -82,22 +487,213 @@ public:
 
   virtual literal_t add_variable(bool decision = true,
                                  bool polarity = false) = 0;
-  virtual void add_clause(const std::vector<literal_t> &clause) = 0;
-  virtual void add_clause(literal_t lit1) = 0;
-  virtual void add_clause(literal_t lit1, literal_t lit2) = 0;
-  virtual void add_clause(literal_t lit1, literal_t lit2, literal_t lit3) = 0;
+
+  /**
+   * Adds many clauses at once given as a flat list of literals where each
+   * clause is terminated by a zero literal, as in the DIMACS format.
+   */
+  void add_clauses(const std::vector<literal_t> &clauses) {
+    stats.encoded_clauses += std::count(clauses.begin(), clauses.end(), 0);
+    if (polarity_gates)
+      require_literals(clauses.data(), clauses.size());
+    push_clauses(clauses);
+  }
+
+  /**
+   * Adds a single clause. The clauses are collected in a buffer and passed to
+   * the backend in bulk.
+   */
+  void add_clause(const std::vector<literal_t> &clause) {
+    buffer.insert(buffer.end(), clause.begin(), clause.end());
+    buffer_clause();
+  }
+
+  void add_clause(literal_t lit1) {
+    buffer.push_back(lit1);
+    buffer_clause();
+  }
+
+  void add_clause(literal_t lit1, literal_t lit2) {
+    buffer.push_back(lit1);
+    buffer.push_back(lit2);
+    buffer_clause();
+  }
+
+  void add_clause(literal_t lit1, literal_t lit2, literal_t lit3) {
+    buffer.push_back(lit1);
+    buffer.push_back(lit2);
+    buffer.push_back(lit3);
+    buffer_clause();
+  }
 
   virtual unsigned long get_variables() const = 0;
   virtual unsigned long get_clauses() const = 0;
 
-  virtual bool solve() = 0;
+  /**
+   * Solves the problem with the given literals temporarily assumed to be
+   * true. The clauses learnt during the search are kept for later calls.
+   * Returns false if there is no solution under these assumptions, in which
+   * case the failed assumptions are available.
+   */
+  bool solve(const std::vector<literal_t> &assumptions) {
+    return solve(assumptions, budget_t()) == RESULT_SAT;
+  }
+
+  bool solve() { return solve(std::vector<literal_t>()); }
+
+  /**
+   * Solves the problem under the assumptions within the given budget. The
+   * time limit is enforced by a timer thread that interrupts the search.
+   * Returns RESULT_UNKNOWN if the budget is exhausted or the call is
+   * interrupted, in which case there are no failed assumptions.
+   */
+  result_t solve(const std::vector<literal_t> &assumptions,
+                 const budget_t &budget);
+
+  /**
+   * Starts solving on a new thread and returns the future result. The solver
+   * must not be used until the result is ready, except that the call can be
+   * cancelled with interrupt.
+   */
+  std::future<result_t> solve_async(const std::vector<literal_t> &assumptions,
+                                    const budget_t &budget = budget_t());
+
+  /**
+   * Asks the solve call running on another thread to stop as soon as
+   * possible, when it returns RESULT_UNKNOWN. If no call is running, then the
+   * next one is stopped.
+   */
+  void interrupt();
+
+  /**
+   * Withdraws an interrupt that has not stopped a solve call yet.
+   */
+  void clear_interrupt();
+
+  /**
+   * Returns the subset of the assumptions that made the last call of solve
+   * unsatisfiable, which is empty if the problem has no solution at all.
+   */
+  const std::vector<literal_t> &get_failed_assumptions() const {
+    return failed;
+  }
+
   virtual literal_t get_solution(literal_t lit) const = 0;
 
+  /**
+   * Stores the values of the given literals in the current solution into the
+   * bit vector of the same length. Undefined values are stored as false.
+   */
+  virtual void get_solution(const std::vector<literal_t> &lits,
+                            bitvec_t *vec) const;
+
+  /**
+   * Adds the clause that excludes the given values of the literals, which are
+   * typically the ones returned by the previous method.
+   */
+  void add_blocking_clause(const std::vector<literal_t> &lits,
+                           const bitvec_t *vec);
+
+  /**
+   * Enumerates the solutions projected to the given literals, that is the
+   * distinct values of these literals in the solutions. The callback is called
+   * with the packed values of each one, and the enumeration stops early if it
+   * returns false. Each solution is excluded with a blocking clause over the
+   * projection only. If assumptions are given, then only the solutions under
+   * them are enumerated. Returns the number of solutions found.
+   */
+  unsigned long
+  enumerate(const std::vector<literal_t> &projection,
+            const std::function<bool(const bitvec_t *values)> &callback,
+            const std::vector<literal_t> &assumptions = {});
+
+  /**
+   * Enables or disables the structural hashing of the and, add and majority
+   * gates. When enabled, building the same gate twice returns the previously
+   * created output literal instead of a fresh variable.
+   */
+  void set_hashing(bool enable) { hashing = enable; }
+  bool get_hashing() const { return hashing; }
+
+  /**
+   * Returns the number of gates found in and added to the structural hash
+   * table since the last clear.
+   */
+  unsigned long get_hash_hits() const { return hash_hits; }
+  unsigned long get_hash_misses() const { return hash_misses; }
+
+  /**
+   * Selects the encoding of the n-ary operations. When enabled (the default)
+   * the n-ary and and or are encoded with a single output variable and the
+   * n-ary sum with a balanced tree of binary sums, otherwise all of them are
+   * encoded as a left to right chain of binary gates.
+   */
+  void set_nary_gates(bool enable) { nary = enable; }
+  bool get_nary_gates() const { return nary; }
+
+  /**
+   * Selects the encoding of the at least, at most and exactly k constraints.
+   */
+  void set_cardinality(card_encoding_t encoding) { cardinality = encoding; }
+  card_encoding_t get_cardinality() const { return cardinality; }
+
+  /**
+   * Enables or disables the polarity aware (Plaisted-Greenbaum) encoding of
+   * the gates. When enabled, only those halves of the gate definitions are
+   * emitted that are needed for the polarities in which the gate outputs
+   * occur in the clauses, and the other halves are emitted only when the
+   * output is later used in the other polarity. The solution values of gate
+   * outputs with a missing half are not necessarily consistent with their
+   * inputs. Disabling emits all pending halves.
+   */
+  void set_polarity_gates(bool enable);
+  bool get_polarity_gates() const { return polarity_gates; }
+
+  /**
+   * Selects the at most one encoding used when AMO_DEFAULT is requested.
+   */
+  void set_amo_encoding(amo_encoding_t encoding) {
+    amo = encoding != AMO_DEFAULT ? encoding : AMO_LADDER;
+  }
+  amo_encoding_t get_amo_encoding() const { return amo; }
+
+  /**
+   * Returns the statistics of the search and of the encoding. The backends
+   * add their search counters to the ones collected here.
+   */
+  virtual stats_t get_stats() const;
+
+  /**
+   * Attaches a profiler that attributes the variables and clauses created in
+   * the profiled sections to their tag stack. It should be attached before
+   * the encoding starts, and can be shared by several solvers used one after
+   * the other.
+   */
+  void set_profiler(const std::shared_ptr<Profiler> &profiler) {
+    this->profiler = profiler;
+  }
+  const std::shared_ptr<Profiler> &get_profiler() const { return profiler; }
+
+  void profile_push(const char *tag) override;
+  void profile_pop(const char *tag) override;
+
   literal_t logic_and(literal_t lit1, literal_t lit2) override;
   literal_t logic_add(literal_t lit1, literal_t lit2) override;
   literal_t logic_maj(literal_t lit1, literal_t lit2, literal_t lit3) override;
+  literal_t logic_all(const std::vector<literal_t> &lits) override;
+  literal_t logic_any(const std::vector<literal_t> &lits) override;
+  literal_t logic_sum(const std::vector<literal_t> &lits) override;
+  literal_t logic_atleast(const std::vector<literal_t> &lits, int k) override;
+  literal_t logic_exactly(const std::vector<literal_t> &lits, int k) override;
+  literal_t logic_amo(const std::vector<literal_t> &lits,
+                      amo_encoding_t encoding) override;
 };
 
+/**
+ * Prints out the statistics as a JSON object.
+ */
+std::ostream &operator<<(std::ostream &out, const Solver::stats_t &stats);
+
 } // namespace uasat
 
 #endif // UASAT_SOLVER_HPP
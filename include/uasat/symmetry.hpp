@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UASAT_SYMMETRY_HPP
+#define UASAT_SYMMETRY_HPP
+
+#include <vector>
+
+namespace uasat {
+
+class Tensor;
+
+class Symmetry {
+protected:
+  std::vector<int> axes;
+  std::vector<std::vector<int>> perms;
+
+public:
+  /**
+   * The permutations that are compared against the element: the adjacent
+   * transpositions (i i+1), all transpositions, or all permutations. Only the
+   * last one keeps exactly one element of each orbit, but it has size! - 1
+   * comparisons, so it is limited to MAX_COMPLETE_SIZE.
+   */
+  enum generators_t { ADJACENT, TRANSPOSITIONS, COMPLETE };
+
+  static const int MAX_COMPLETE_SIZE = 6;
+
+  /**
+   * Creates the symmetric group on the given size acting on the elements by
+   * renaming the coordinates of all the given axes simultaneously. The
+   * default adjacent transpositions break the symmetry only partially, so
+   * some isomorphic copies are kept.
+   */
+  Symmetry(int size, const std::vector<int> &axes,
+           generators_t generators = ADJACENT);
+
+  /**
+   * Creates the symmetry generated by the given permutations acting on the
+   * coordinates of all the given axes simultaneously.
+   */
+  Symmetry(const std::vector<int> &axes,
+           const std::vector<std::vector<int>> &perms);
+
+  /**
+   * The axes renamed by the permutations.
+   */
+  const std::vector<int> &get_axes() const { return axes; }
+
+  /**
+   * The permutations whose images are compared against the element.
+   */
+  const std::vector<std::vector<int>> &get_permutations() const {
+    return perms;
+  }
+
+  /**
+   * Returns the scalar tensor that is true if the element is lexicographically
+   * less than or equal to its images under all permutations. With all
+   * permutations of a group exactly one element of each orbit satisfies it.
+   */
+  Tensor lex_leader(const Tensor &elem) const;
+};
+
+} // namespace uasat
+
+#endif // UASAT_SYMMETRY_HPP
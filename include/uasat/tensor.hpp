@@ -28,6 +28,8 @@
 
 namespace uasat {
 
+struct bitvec_t;
+
 class Tensor {
 protected:
   /**
@@ -45,12 +47,67 @@ protected:
   /**
    * The elements of the tensor are stored in an array. Each element is
    * identified by an index within this array and also by a list of coordinates,
-   * one for each axis.
+   * one for each axis. The array is shared between copies of the tensor and it
+   * is copied only when one of them is modified. Boolean tensors do not use
+   * it.
    */
-  std::vector<literal_t> storage;
+  std::shared_ptr<std::vector<literal_t>> storage;
+
+  /**
+   * The elements of a boolean tensor are packed into this bit vector, one bit
+   * per element in the default order, and evaluated with word-wide kernels.
+   * It is shared between copies just like the storage, and it is null for
+   * every other logic.
+   */
+  std::shared_ptr<bitvec_t> bits;
+
+  /**
+   * The distance within the storage between consecutive elements along each
+   * axis if this tensor is a strided view of the storage (for example a lazy
+   * polymer), or empty if the elements are stored contiguously with the first
+   * axis changing the fastest.
+   */
+  std::vector<size_t> strides;
 
   Tensor(const std::shared_ptr<Logic> &logic, const std::vector<int> &shape);
 
+  /**
+   * Creates a view of the given storage with the given strides.
+   */
+  Tensor(const std::shared_ptr<Logic> &logic, const std::vector<int> &shape,
+         const std::shared_ptr<std::vector<literal_t>> &storage,
+         const std::vector<size_t> &strides);
+
+  /**
+   * Creates a boolean tensor whose elements are packed in the given bits.
+   */
+  Tensor(const std::vector<int> &shape, const std::shared_ptr<bitvec_t> &bits);
+
+  /**
+   * Returns this tensor with its boolean values unpacked into the storage as
+   * literals, which the generic operations work with.
+   */
+  Tensor unpack() const;
+
+  /**
+   * Returns this tensor with its values packed into bits if it is boolean.
+   * This is the inverse of the unpack operation.
+   */
+  Tensor pack() const;
+
+  /**
+   * Returns the strides of the axes within the storage, also for contiguous
+   * tensors.
+   */
+  std::vector<size_t> get_strides() const;
+
+  /**
+   * Makes sure that the storage is contiguous and not shared with other
+   * tensors, must be called before modifying the elements of an existing
+   * tensor.
+   */
+  void detach();
+
   /**
    * Performs the given generic binary logic operation on the given tensors.
    */
@@ -63,6 +120,25 @@ protected:
   Tensor logic_ter(literal_t (Logic::*op)(literal_t, literal_t, literal_t),
                    const Tensor &tensor2, const Tensor &tensor3) const;
 
+  /**
+   * Folds this tensor along the first axis using the given generic n-ary logic
+   * operation.
+   */
+  Tensor
+  fold_nary(literal_t (Logic::*op)(const std::vector<literal_t> &)) const;
+
+  /**
+   * Folds this tensor along the first axis by calling the given function with
+   * the list of folded literals for each output element.
+   */
+  template <typename FUNC> Tensor fold_lits(FUNC func) const;
+
+  /**
+   * Folds this packed tensor along the first axis by calling the given
+   * predicate with the number of true values for each output element.
+   */
+  template <typename PRED> Tensor fold_bits(PRED pred) const;
+
   /**
    * Returns the index of the element identified by the given coordinates.
    */
@@ -82,17 +158,13 @@ public:
   /**
    * Returns the literal in this tensor at the given coordinates.
    */
-  literal_t __very_slow_get_value(const std::vector<int> &coords) const {
-    return storage[__very_slow_get_index(coords)];
-  }
+  literal_t __very_slow_get_value(const std::vector<int> &coords) const;
 
   /**
    * Returns the literal in this tensor at the given coordinates.
    */
   void __very_slow_set_value(const std::vector<int> &coords,
-                             literal_t literal) {
-    storage[__very_slow_get_index(coords)] = literal;
-  }
+                             literal_t literal);
 
   /**
    * Creates a new tensor with the given shape with fresh variables from the
@@ -121,11 +193,44 @@ public:
    * Creates a new tensor of the given shape from the given old tensor with
    * permuted, identified or new dummy coordinates. The mapping is a vector of
    * length of the old tensor shape with entries identifying the coordinate in
-   * the new tensor.
+   * the new tensor. The result is a strided view that shares the storage of
+   * this tensor, so broadcasting is free until the elements are combined.
+   * The bits of boolean tensors are copied instead, as they are small.
    */
   Tensor polymer(const std::vector<int> &shape,
                  const std::vector<int> &mapping) const;
 
+  /**
+   * Returns a tensor with the same elements stored contiguously. This is the
+   * tensor itself unless it is a strided view. Calling it can pay off when
+   * the same view is consumed many times.
+   */
+  Tensor materialize() const;
+
+  /**
+   * Returns the tensor obtained by renaming the coordinates along the given
+   * axes with the permutation, so the element at coordinates x is the element
+   * of this tensor where x_i is replaced with perm[x_i] for the given axes.
+   * All of these axes must have the same dimension as the permutation.
+   */
+  Tensor permute(const std::vector<int> &axes,
+                 const std::vector<int> &perm) const;
+
+  /**
+   * Computes the polymers of this and the other tensor with the given shape and
+   * mappings, combines them elementwise with the given binary operation, and
+   * folds the result along the first axis with the given n-ary operation. The
+   * broadcast and combined intermediate tensors are never materialized. By
+   * default this is the relational composition.
+   */
+  Tensor contract(const std::vector<int> &shape,
+                  const std::vector<int> &mapping1, const Tensor &tensor2,
+                  const std::vector<int> &mapping2,
+                  literal_t (Logic::*combine)(literal_t,
+                                              literal_t) = &Logic::logic_and,
+                  literal_t (Logic::*reduce)(const std::vector<literal_t> &) =
+                      &Logic::logic_any) const;
+
   /**
    * Reshapes the first rank many axes of the tensor to dims so that the number
    * and linear indices of elements stays the same but the shape vector is
@@ -206,26 +311,59 @@ public:
     return logic_ter(&Logic::logic_iff, tensor2, tensor3);
   }
 
+  /**
+   * Returns the scalar tensor that is true if this tensor is lexicographically
+   * less than or equal to the other tensor of the same shape. The elements are
+   * compared in storage order, the first one being the most significant, and
+   * false is smaller than true.
+   */
+  Tensor lex_leq(const Tensor &tensor2) const;
+
   /**
    * Folds this tensor along the first axis using the logical and operation.
    */
-  Tensor fold_all() const;
+  Tensor fold_all() const { return fold_nary(&Logic::logic_all); }
 
   /**
    * Folds this tensor along the first axis using the binary or operation.
    */
-  Tensor fold_any() const;
+  Tensor fold_any() const { return fold_nary(&Logic::logic_any); }
 
   /**
    * Folds this tensor along the first axis using the binary addition operation.
    */
-  Tensor fold_sum() const;
+  Tensor fold_sum() const { return fold_nary(&Logic::logic_sum); }
+
+  /**
+   * Folds this tensor along the first axis and returns true if there is at
+   * most one true value among the folded values. The default encoding is the
+   * one selected in the solver.
+   */
+  Tensor fold_amo(Logic::amo_encoding_t encoding = Logic::AMO_DEFAULT) const;
 
   /**
    * Folds this tensor along the first axis and returns true if there is exactly
    * one true value among the folded values.
    */
-  Tensor fold_one() const;
+  Tensor fold_one(Logic::amo_encoding_t encoding = Logic::AMO_DEFAULT) const;
+
+  /**
+   * Folds this tensor along the first axis and returns true if there are at
+   * least k true values among the folded values.
+   */
+  Tensor fold_atleast(int k) const;
+
+  /**
+   * Folds this tensor along the first axis and returns true if there are at
+   * most k true values among the folded values.
+   */
+  Tensor fold_atmost(int k) const { return fold_atleast(k + 1).logic_not(); }
+
+  /**
+   * Folds this tensor along the first axis and returns true if there are
+   * exactly k true values among the folded values.
+   */
+  Tensor fold_exactly(int k) const;
 
   /**
    * Returns the scalar value of a zero rank tensor.
@@ -238,6 +376,24 @@ public:
    */
   Tensor get_solution(const std::shared_ptr<Solver> &solver) const;
 
+  /**
+   * Returns the current solution like the previous method and adds the clause
+   * to the solver that excludes this solution.
+   */
+  Tensor block_solution(const std::shared_ptr<Solver> &solver) const;
+
+  /**
+   * Copies the values of this boolean tensor into a newly created bit vector,
+   * which must be destroyed by the caller.
+   */
+  bitvec_t *to_bitvec() const;
+
+  /**
+   * Creates a boolean tensor of the given shape from the packed values.
+   */
+  static Tensor from_bitvec(const std::vector<int> &shape,
+                            const bitvec_t *vec);
+
   /**
    * Adds the literals of this tensor to the clause.
    */
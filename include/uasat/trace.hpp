@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UASAT_TRACE_HPP
+#define UASAT_TRACE_HPP
+
+#include <chrono>
+#include <iosfwd>
+#include <vector>
+
+namespace uasat {
+
+class Tracer {
+public:
+  /**
+   * Starts recording the traced sections of all threads, and forgets the
+   * previously recorded events.
+   */
+  static void start();
+
+  /**
+   * Stops recording, the events are kept until the next start.
+   */
+  static void stop();
+
+  /**
+   * Returns true if the sections are recorded.
+   */
+  static bool is_recording();
+
+  /**
+   * Records a complete event with the given name, time interval, input shape
+   * and output shape of a tensor operation (both can be empty).
+   */
+  static void record(const char *name,
+                     std::chrono::steady_clock::time_point begin,
+                     std::chrono::steady_clock::time_point end,
+                     const std::vector<int> &shape,
+                     const std::vector<int> &output);
+
+  /**
+   * Prints out the recorded events in the Chrome trace event JSON format,
+   * which can be loaded into chrome://tracing or Perfetto.
+   */
+  static void write(std::ostream &out);
+};
+
+/**
+ * Records the lifetime of this object as a traced section if the tracer is
+ * recording. Use the UASAT_TRACE_SCOPE macro, which compiles to nothing
+ * unless UASAT_TRACE is defined.
+ */
+class TraceScope {
+protected:
+  const char *name;
+  std::vector<int> shape;
+  std::vector<int> output;
+  bool recording;
+  std::chrono::steady_clock::time_point begin;
+
+public:
+  TraceScope(const char *name);
+  TraceScope(const char *name, const std::vector<int> &shape,
+             const std::vector<int> &output);
+  ~TraceScope();
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+};
+
+} // namespace uasat
+
+#ifdef UASAT_TRACE
+#define UASAT_TRACE_CONCAT2(a, b) a##b
+#define UASAT_TRACE_CONCAT(a, b) UASAT_TRACE_CONCAT2(a, b)
+#define UASAT_TRACE_SCOPE(...)                                                 \
+  ::uasat::TraceScope UASAT_TRACE_CONCAT(uasat_trace_, __LINE__)(__VA_ARGS__)
+#else
+#define UASAT_TRACE_SCOPE(...)                                                 \
+  do {                                                                         \
+  } while (false)
+#endif
+
+#endif // UASAT_TRACE_HPP
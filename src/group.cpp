@@ -21,6 +21,7 @@
  */
 
 #include "uasat/group.hpp"
+#include "uasat/profile.hpp"
 #include "uasat/tensor.hpp"
 #include <cassert>
 #include <iostream>
@@ -28,77 +29,86 @@
 
 namespace uasat {
 
-void AbstractGroup::test_axioms() {
+void AbstractGroup::test_axioms(const std::shared_ptr<Profiler> &profiler) {
   if (contains(identity()).get_scalar() != Logic::TRUE) {
     std::cout << "does not contain the identity elem";
     std::cout << identity() << std::endl;
   }
 
+  // the axioms are encoded once and each violation is guarded by its own
+  // activation literal, so they can be checked with incremental solving
   std::shared_ptr<Solver> solver = Solver::create();
+  solver->set_hashing(true);
+  solver->set_profiler(profiler);
   Tensor elem1 = Tensor::variable(solver, get_shape());
-  solver->add_clause(contains(elem1)
-                         .logic_leq(contains(inverse(elem1)))
-                         .logic_not()
-                         .get_scalar());
-  if (solver->solve()) {
-    std::cout << "not closed under taking the inverse" << std::endl;
-    std::cout << elem1.get_solution(solver) << std::endl;
+  Tensor elem2 = Tensor::variable(solver, get_shape());
+  Tensor elem3 = Tensor::variable(solver, get_shape());
+  auto violated = [&solver](const Tensor &violation) {
+    literal_t active = solver->add_variable();
+    solver->add_clause(solver->logic_not(active), violation.get_scalar());
+    bool result = solver->solve({active});
+    // retire the activation literal, the model stays readable until the
+    // next solve and the guarded clause can be simplified away
+    solver->add_clause(solver->logic_not(active));
+    return result;
+  };
+
+  {
+    ProfileScope scope(*solver, "inverse_closed");
+    if (violated(contains(elem1)
+                     .logic_leq(contains(inverse(elem1)))
+                     .logic_not())) {
+      std::cout << "not closed under taking the inverse" << std::endl;
+      std::cout << elem1.get_solution(solver) << std::endl;
+    }
   }
 
-  solver->clear();
-  elem1 = Tensor::variable(solver, get_shape());
-  Tensor elem2 = Tensor::variable(solver, get_shape());
-  solver->add_clause(contains(elem1)
-                         .logic_and(contains(elem2))
-                         .logic_leq(contains(product(elem1, elem2)))
-                         .logic_not()
-                         .get_scalar());
-  if (solver->solve()) {
-    std::cout << "not closed under taking the product" << std::endl;
-    std::cout << elem1.get_solution(solver) << std::endl;
-    std::cout << elem2.get_solution(solver) << std::endl;
+  {
+    ProfileScope scope(*solver, "product_closed");
+    if (violated(contains(elem1)
+                     .logic_and(contains(elem2))
+                     .logic_leq(contains(product(elem1, elem2)))
+                     .logic_not())) {
+      std::cout << "not closed under taking the product" << std::endl;
+      std::cout << elem1.get_solution(solver) << std::endl;
+      std::cout << elem2.get_solution(solver) << std::endl;
+    }
   }
 
-  solver->clear();
-  elem1 = Tensor::variable(solver, get_shape());
-  solver->add_clause(contains(elem1)
-                         .logic_leq(equals(product(identity(), elem1), elem1))
-                         .logic_not()
-                         .get_scalar());
-  if (solver->solve()) {
-    std::cout << "left identity axiom is not satisfied" << std::endl;
-    std::cout << elem1.get_solution(solver) << std::endl;
+  {
+    ProfileScope scope(*solver, "left_identity");
+    if (violated(contains(elem1)
+                     .logic_leq(equals(product(identity(), elem1), elem1))
+                     .logic_not())) {
+      std::cout << "left identity axiom is not satisfied" << std::endl;
+      std::cout << elem1.get_solution(solver) << std::endl;
+    }
   }
 
-  solver->clear();
-  elem1 = Tensor::variable(solver, get_shape());
-  solver->add_clause(
-      contains(elem1)
-          .logic_leq(equals(product(inverse(elem1), elem1), identity()))
-          .logic_not()
-          .get_scalar());
-  if (solver->solve()) {
-    std::cout << "left inverse axiom is not satisfied" << std::endl;
-    std::cout << elem1.get_solution(solver) << std::endl;
+  {
+    ProfileScope scope(*solver, "left_inverse");
+    if (violated(
+            contains(elem1)
+                .logic_leq(equals(product(inverse(elem1), elem1), identity()))
+                .logic_not())) {
+      std::cout << "left inverse axiom is not satisfied" << std::endl;
+      std::cout << elem1.get_solution(solver) << std::endl;
+    }
   }
 
-  solver->clear();
-  elem1 = Tensor::variable(solver, get_shape());
-  elem2 = Tensor::variable(solver, get_shape());
-  Tensor elem3 = Tensor::variable(solver, get_shape());
-  solver->add_clause(
-      contains(elem1)
-          .logic_and(contains(elem2))
-          .logic_and(contains(elem3))
-          .logic_leq(equals(product(product(elem1, elem2), elem3),
-                            product(elem1, product(elem2, elem3))))
-          .logic_not()
-          .get_scalar());
-  if (solver->solve()) {
-    std::cout << "associativity axiom is not satisfied" << std::endl;
-    std::cout << elem1.get_solution(solver) << std::endl;
-    std::cout << elem2.get_solution(solver) << std::endl;
-    std::cout << elem3.get_solution(solver) << std::endl;
+  {
+    ProfileScope scope(*solver, "associativity");
+    if (violated(contains(elem1)
+                     .logic_and(contains(elem2))
+                     .logic_and(contains(elem3))
+                     .logic_leq(equals(product(product(elem1, elem2), elem3),
+                                       product(elem1, product(elem2, elem3))))
+                     .logic_not())) {
+      std::cout << "associativity axiom is not satisfied" << std::endl;
+      std::cout << elem1.get_solution(solver) << std::endl;
+      std::cout << elem2.get_solution(solver) << std::endl;
+      std::cout << elem3.get_solution(solver) << std::endl;
+    }
   }
 }
 
@@ -123,20 +133,14 @@ Tensor SymmetricGroup::inverse(const Tensor &perm) {
 
 Tensor SymmetricGroup::product(const Tensor &perm1, const Tensor &perm2) {
   assert(check_shape(perm1.get_shape()) && check_shape(perm2.get_shape()));
-  return perm1.polymer({size, size, size}, {1, 0})
-      .logic_and(perm2.polymer({size, size, size}, {0, 2}))
-      .fold_any();
+  return perm1.contract({size, size, size}, {1, 0}, perm2, {0, 2});
 }
 
 Tensor SymmetricGroup::even(const Tensor &perm) {
   assert(check_shape(perm.get_shape()));
   Tensor less = Tensor::lessthan(size);
-  Tensor rel1 = less.polymer({size, size, size}, {1, 0})
-                    .logic_and(perm.polymer({size, size, size}, {0, 2}))
-                    .fold_any();
-  Tensor rel2 = less.polymer({size, size, size}, {2, 0})
-                    .logic_and(perm.polymer({size, size, size}, {1, 0}))
-                    .fold_any();
+  Tensor rel1 = less.contract({size, size, size}, {1, 0}, perm, {0, 2});
+  Tensor rel2 = less.contract({size, size, size}, {2, 0}, perm, {1, 0});
   return rel1.logic_and(rel2).reshape(2, {size * size}).fold_sum();
 }
 
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uasat/profile.hpp"
+#include "uasat/solver.hpp"
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+namespace uasat {
+
+/**
+ * Returns the difference of the counters, or zero if the second is larger.
+ */
+unsigned long get_increase(unsigned long after, unsigned long before) {
+  return after > before ? after - before : 0;
+}
+
+void Profiler::push(const char *tag, unsigned long variables,
+                    unsigned long clauses) {
+  node_t *parent = stack.empty() ? &root : stack.back().node;
+
+  node_t *node = nullptr;
+  for (const std::unique_ptr<node_t> &child : parent->children)
+    if (child->tag == tag) {
+      node = child.get();
+      break;
+    }
+
+  if (node == nullptr) {
+    parent->children.emplace_back(new node_t());
+    node = parent->children.back().get();
+    node->tag = tag;
+  }
+
+  stack.push_back(
+      frame_t{node, variables, clauses, std::chrono::steady_clock::now()});
+}
+
+void Profiler::pop(const char *tag, unsigned long variables,
+                   unsigned long clauses) {
+  // sections opened before the profiler was attached are ignored
+  if (stack.empty() || stack.back().node->tag != tag)
+    return;
+
+  const frame_t &frame = stack.back();
+  std::chrono::duration<double> time =
+      std::chrono::steady_clock::now() - frame.start;
+  frame.node->calls += 1;
+  frame.node->variables += get_increase(variables, frame.variables);
+  frame.node->clauses += get_increase(clauses, frame.clauses);
+  frame.node->time += time.count();
+  stack.pop_back();
+}
+
+void Profiler::clear() {
+  if (!stack.empty())
+    throw std::logic_error("cannot clear profiler with open sections");
+  root.children.clear();
+  stack.clear();
+}
+
+void Profiler::print(std::ostream &out, const node_t &node, int depth) const {
+  unsigned long variables = 0;
+  unsigned long clauses = 0;
+  for (const std::unique_ptr<node_t> &child : node.children) {
+    variables += child->variables;
+    clauses += child->clauses;
+  }
+  variables = get_increase(node.variables, variables);
+  clauses = get_increase(node.clauses, clauses);
+
+  std::string name = std::string(2 * depth, ' ') + node.tag;
+  out << std::left << std::setw(32) << name << std::right << std::setw(10)
+      << node.calls << std::setw(13) << node.variables << std::setw(13)
+      << node.clauses << std::setw(13) << variables << std::setw(13)
+      << clauses << std::setw(13) << std::fixed << std::setprecision(3)
+      << node.time << std::endl;
+
+  for (const std::unique_ptr<node_t> &child : node.children)
+    print(out, *child, depth + 1);
+}
+
+void Profiler::print(std::ostream &out) const {
+  std::ios::fmtflags flags = out.flags();
+  out << std::left << std::setw(32) << "tag" << std::right << std::setw(10)
+      << "calls" << std::setw(13) << "variables" << std::setw(13) << "clauses"
+      << std::setw(13) << "self vars" << std::setw(13) << "self clauses"
+      << std::setw(13) << "time (s)" << std::endl;
+
+  for (const std::unique_ptr<node_t> &child : root.children)
+    print(out, *child, 0);
+  out.flags(flags);
+}
+
+void Profiler::print_json(std::ostream &out, const node_t &node) const {
+  unsigned long variables = 0;
+  unsigned long clauses = 0;
+  for (const std::unique_ptr<node_t> &child : node.children) {
+    variables += child->variables;
+    clauses += child->clauses;
+  }
+  variables = get_increase(node.variables, variables);
+  clauses = get_increase(node.clauses, clauses);
+
+  // the tags are identifiers, so they need no escaping
+  out << "{\"tag\": \"" << node.tag << "\", \"calls\": " << node.calls
+      << ", \"variables\": " << node.variables
+      << ", \"clauses\": " << node.clauses
+      << ", \"self_variables\": " << variables
+      << ", \"self_clauses\": " << clauses << ", \"time\": " << node.time
+      << ", \"children\": [";
+  for (size_t i = 0; i < node.children.size(); i++) {
+    if (i != 0)
+      out << ", ";
+    print_json(out, *node.children[i]);
+  }
+  out << "]}";
+}
+
+void Profiler::print_json(std::ostream &out) const {
+  out << "[";
+  for (size_t i = 0; i < root.children.size(); i++) {
+    if (i != 0)
+      out << ", ";
+    print_json(out, *root.children[i]);
+  }
+  out << "]";
+}
+
+ProfileScope::ProfileScope(Logic &logic, const char *tag)
+    : logic(logic), tag(tag) {
+  logic.profile_push(tag);
+}
+
+ProfileScope::~ProfileScope() { logic.profile_pop(tag); }
+
+} // namespace uasat
@@ -21,11 +21,136 @@
  */
 
 #include "uasat/set.hpp"
+#include "uasat/bitvec.hpp"
+#include "uasat/profile.hpp"
+#include "uasat/symmetry.hpp"
 #include "uasat/tensor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <stdexcept>
+#include <thread>
 
 namespace uasat {
 
+std::shared_ptr<Solver>
+encode_elements(const std::vector<int> &shape,
+                const std::function<Tensor(const Tensor &elem)> &contains,
+                const Symmetry *symmetry, std::vector<literal_t> &projection) {
+  std::shared_ptr<Solver> solver = Solver::create();
+  Tensor elem = Tensor::variable(solver, shape);
+  solver->add_clause(contains(elem).get_scalar());
+  if (symmetry != nullptr)
+    solver->add_clause(symmetry->lex_leader(elem).get_scalar());
+
+  projection.clear();
+  elem.extend_clause(projection);
+  return solver;
+}
+
+typedef std::unique_ptr<bitvec_t, void (*)(bitvec_t *)> bitvec_ptr;
+
+/**
+ * Enumerates the elements with one solver per worker thread. The first few
+ * projected literals are fixed by assumptions to obtain the cubes, which are
+ * handed out to the workers in order. The values are collected and sorted if
+ * the results are given, otherwise only counted.
+ */
+unsigned long enumerate_parallel(
+    const std::vector<int> &shape,
+    const std::function<Tensor(const Tensor &elem)> &contains,
+    const Symmetry *symmetry, int threads, std::vector<bitvec_ptr> *results) {
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // the encoding is built on this thread, the sets need not be thread safe
+  std::vector<std::shared_ptr<Solver>> solvers;
+  std::vector<std::vector<literal_t>> projections(threads);
+  for (int i = 0; i < threads; i++)
+    solvers.push_back(
+        encode_elements(shape, contains, symmetry, projections[i]));
+
+  // aim for several cubes per worker to balance the load
+  size_t depth = 0;
+  while (depth < projections[0].size() && depth < 20 &&
+         (size_t(1) << depth) < 8 * size_t(threads))
+    depth += 1;
+
+  size_t cubes = size_t(1) << depth;
+  std::vector<unsigned long> counts(cubes, 0);
+  std::vector<std::vector<bitvec_ptr>> values(results != nullptr ? cubes : 0);
+
+  std::atomic<size_t> next(0);
+  std::vector<std::exception_ptr> errors(threads);
+  auto work = [&](int index) {
+    try {
+      Solver &solver = *solvers[index];
+      const std::vector<literal_t> &projection = projections[index];
+      std::vector<literal_t> assumptions(depth);
+      for (size_t cube; (cube = next++) < cubes;) {
+        for (size_t i = 0; i < depth; i++)
+          assumptions[i] =
+              (cube >> i) & 1 ? projection[i] : solver.logic_not(projection[i]);
+
+        counts[cube] = solver.enumerate(
+            projection,
+            [&](const bitvec_t *vec) {
+              if (results != nullptr) {
+                bitvec_ptr copy(bitvec_t::create(projection.size()),
+                                bitvec_t::destroy);
+                bitvec_t::copy(copy.get(), vec);
+                values[cube].push_back(std::move(copy));
+              }
+              return true;
+            },
+            assumptions);
+      }
+    } catch (...) {
+      errors[index] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads; i++)
+    workers.emplace_back(work, i);
+  work(0);
+  for (std::thread &worker : workers)
+    worker.join();
+
+  for (const std::exception_ptr &error : errors)
+    if (error)
+      std::rethrow_exception(error);
+
+  unsigned long count = 0;
+  for (unsigned long c : counts)
+    count += c;
+
+  // the order does not depend on the cubes or on the scheduling
+  if (results != nullptr) {
+    results->clear();
+    results->reserve(count);
+    for (std::vector<bitvec_ptr> &vecs : values)
+      for (bitvec_ptr &vec : vecs)
+        results->push_back(std::move(vec));
+    std::sort(results->begin(), results->end(),
+              [](const bitvec_ptr &vec1, const bitvec_ptr &vec2) {
+                return bitvec_t::less(vec1.get(), vec2.get());
+              });
+  }
+
+  return count;
+}
+
+Tensor stack_elements(const std::vector<int> &shape,
+                      const std::vector<bitvec_ptr> &results) {
+  std::vector<Tensor> elems;
+  elems.reserve(results.size());
+  for (const bitvec_ptr &vec : results)
+    elems.push_back(Tensor::from_bitvec(shape, vec.get()));
+
+  return Tensor::stack(elems);
+}
+
 AbstractSet::AbstractSet(const std::vector<int> &shape) : shape(shape) {}
 
 bool AbstractSet::check_shape(const std::vector<int> &shape2) const {
@@ -40,6 +165,8 @@ bool AbstractSet::check_shape(const std::vector<int> &shape2) const {
 }
 
 Tensor AbstractSet::equals(const Tensor &elem1, const Tensor &elem2) {
+  ProfileScope scope(*Logic::join(elem1.get_logic(), elem2.get_logic()),
+                     "equals");
   Tensor result = elem1.logic_equ(elem2);
 
   size_t size = get_shape().size();
@@ -49,27 +176,55 @@ Tensor AbstractSet::equals(const Tensor &elem1, const Tensor &elem2) {
   return result;
 }
 
-Tensor AbstractSet::find_elements() {
-  std::shared_ptr<Solver> solver = Solver::create();
-  Tensor elem = Tensor::variable(solver, get_shape());
-  solver->add_clause(contains(elem).get_scalar());
+unsigned long AbstractSet::for_each_element(
+    const std::function<bool(const Tensor &elem)> &callback,
+    const Symmetry *symmetry) {
+  std::vector<literal_t> projection;
+  std::shared_ptr<Solver> solver = encode_elements(
+      get_shape(), [this](const Tensor &elem) { return contains(elem); },
+      symmetry, projection);
 
-  std::vector<Tensor> elems;
-  while (solver->solve()) {
-    Tensor t = elem.get_solution(solver);
-    elems.push_back(t);
+  return solver->enumerate(projection, [&](const bitvec_t *values) {
+    return callback(Tensor::from_bitvec(get_shape(), values));
+  });
+}
 
-    std::vector<uasat::literal_t> clause;
-    elem.logic_add(t).extend_clause(clause);
-    solver->add_clause(clause);
-  }
+Tensor AbstractSet::find_elements(const Symmetry *symmetry) {
+  std::vector<Tensor> elems;
+  for_each_element(
+      [&elems](const Tensor &elem) {
+        elems.push_back(elem);
+        return true;
+      },
+      symmetry);
 
   return Tensor::stack(elems);
 }
 
-int AbstractSet::find_cardinality() { return find_elements().get_shape()[0]; }
+int AbstractSet::find_cardinality(const Symmetry *symmetry) {
+  return for_each_element([](const Tensor &) { return true; }, symmetry);
+}
+
+Tensor AbstractSet::find_elements_parallel(int threads,
+                                           const Symmetry *symmetry) {
+  std::vector<bitvec_ptr> results;
+  enumerate_parallel(
+      get_shape(), [this](const Tensor &elem) { return contains(elem); },
+      symmetry, threads, &results);
+
+  return stack_elements(get_shape(), results);
+}
+
+int AbstractSet::find_cardinality_parallel(int threads,
+                                           const Symmetry *symmetry) {
+  return enumerate_parallel(
+      get_shape(), [this](const Tensor &elem) { return contains(elem); },
+      symmetry, threads, nullptr);
+}
 
 Tensor GradedSet::equals(int grade, const Tensor &elem1, const Tensor &elem2) {
+  ProfileScope scope(*Logic::join(elem1.get_logic(), elem2.get_logic()),
+                     "equals");
   Tensor result = elem1.logic_equ(elem2);
 
   size_t size = get_shape(grade).size();
@@ -79,26 +234,55 @@ Tensor GradedSet::equals(int grade, const Tensor &elem1, const Tensor &elem2) {
   return result;
 }
 
-Tensor GradedSet::find_elements(int grade) {
-  std::shared_ptr<Solver> solver = Solver::create();
-  Tensor elem = Tensor::variable(solver, get_shape(grade));
-  solver->add_clause(contains(grade, elem).get_scalar());
+unsigned long GradedSet::for_each_element(
+    int grade, const std::function<bool(const Tensor &elem)> &callback,
+    const Symmetry *symmetry) {
+  std::vector<literal_t> projection;
+  std::shared_ptr<Solver> solver = encode_elements(
+      get_shape(grade),
+      [this, grade](const Tensor &elem) { return contains(grade, elem); },
+      symmetry, projection);
 
-  std::vector<Tensor> elems;
-  while (solver->solve()) {
-    Tensor t = elem.get_solution(solver);
-    elems.push_back(t);
+  return solver->enumerate(projection, [&](const bitvec_t *values) {
+    return callback(Tensor::from_bitvec(get_shape(grade), values));
+  });
+}
 
-    std::vector<uasat::literal_t> clause;
-    elem.logic_add(t).extend_clause(clause);
-    solver->add_clause(clause);
-  }
+Tensor GradedSet::find_elements(int grade, const Symmetry *symmetry) {
+  std::vector<Tensor> elems;
+  for_each_element(
+      grade,
+      [&elems](const Tensor &elem) {
+        elems.push_back(elem);
+        return true;
+      },
+      symmetry);
 
   return Tensor::stack(elems);
 }
 
-int GradedSet::find_cardinality(int grade) {
-  return find_elements(grade).get_shape()[0];
+int GradedSet::find_cardinality(int grade, const Symmetry *symmetry) {
+  return for_each_element(
+      grade, [](const Tensor &) { return true; }, symmetry);
+}
+
+Tensor GradedSet::find_elements_parallel(int grade, int threads,
+                                         const Symmetry *symmetry) {
+  std::vector<bitvec_ptr> results;
+  enumerate_parallel(
+      get_shape(grade),
+      [this, grade](const Tensor &elem) { return contains(grade, elem); },
+      symmetry, threads, &results);
+
+  return stack_elements(get_shape(grade), results);
+}
+
+int GradedSet::find_cardinality_parallel(int grade, int threads,
+                                         const Symmetry *symmetry) {
+  return enumerate_parallel(
+      get_shape(grade),
+      [this, grade](const Tensor &elem) { return contains(grade, elem); },
+      symmetry, threads, nullptr);
 }
 
 } // namespace uasat
@@ -22,8 +22,19 @@
 
 #include "uasat/solver.hpp"
 #include "solvers/minisat.hpp"
+#include "solvers/portfolio.hpp"
+#include "uasat/bitvec.hpp"
+#include "uasat/profile.hpp"
+#include "uasat/trace.hpp"
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <ostream>
+#include <mutex>
+#include <thread>
 
 namespace uasat {
 
@@ -41,6 +52,157 @@ literal_t Logic::logic_iff(literal_t lit1, literal_t lit2, literal_t lit3) {
   return logic_or(logic_and(lit1, lit2), logic_and(logic_not(lit1), lit3));
 }
 
+literal_t Logic::logic_all(const std::vector<literal_t> &lits) {
+  literal_t result = TRUE;
+  for (literal_t lit : lits)
+    result = logic_and(result, lit);
+  return result;
+}
+
+literal_t Logic::logic_any(const std::vector<literal_t> &lits) {
+  literal_t result = FALSE;
+  for (literal_t lit : lits)
+    result = logic_or(result, lit);
+  return result;
+}
+
+literal_t Logic::logic_sum(const std::vector<literal_t> &lits) {
+  literal_t result = FALSE;
+  for (literal_t lit : lits)
+    result = logic_add(result, lit);
+  return result;
+}
+
+literal_t Logic::logic_atleast(const std::vector<literal_t> &lits, int k) {
+  if (k <= 0)
+    return TRUE;
+
+  // counts[j] is true if at least j + 1 of the literals seen so far are true
+  std::vector<literal_t> counts(k, literal_t(FALSE));
+  for (literal_t lit : lits) {
+    for (int j = k - 1; j > 0; j--)
+      counts[j] = logic_or(counts[j], logic_and(lit, counts[j - 1]));
+    counts[0] = logic_or(counts[0], lit);
+  }
+  return counts[k - 1];
+}
+
+literal_t Logic::logic_exactly(const std::vector<literal_t> &lits, int k) {
+  return logic_and(logic_atleast(lits, k), logic_atmost(lits, k));
+}
+
+literal_t amo_pairwise(Logic &logic, const std::vector<literal_t> &lits) {
+  std::vector<literal_t> pairs;
+  for (size_t i = 0; i < lits.size(); i++)
+    for (size_t j = i + 1; j < lits.size(); j++)
+      pairs.push_back(logic.logic_and(lits[i], lits[j]));
+  return logic.logic_not(logic.logic_any(pairs));
+}
+
+literal_t amo_ladder(Logic &logic, const std::vector<literal_t> &lits) {
+  // a literal is bad if it is true and one before it is true as well
+  literal_t prefix = Logic::FALSE;
+  literal_t bad = Logic::FALSE;
+  for (literal_t lit : lits) {
+    bad = logic.logic_or(bad, logic.logic_and(prefix, lit));
+    prefix = logic.logic_or(prefix, lit);
+  }
+  return logic.logic_not(bad);
+}
+
+/**
+ * Returns the or of each consecutive group of the given size, and the and
+ * of the pairwise at most one constraints of the groups.
+ */
+literal_t amo_groups(Logic &logic, const std::vector<literal_t> &lits,
+                     size_t size, std::vector<literal_t> &groups) {
+  std::vector<literal_t> amos;
+  for (size_t i = 0; i < lits.size(); i += size) {
+    size_t end = std::min(i + size, lits.size());
+    std::vector<literal_t> group(lits.begin() + i, lits.begin() + end);
+    groups.push_back(logic.logic_any(group));
+    amos.push_back(amo_pairwise(logic, group));
+  }
+  return logic.logic_all(amos);
+}
+
+literal_t amo_commander(Logic &logic, const std::vector<literal_t> &lits) {
+  if (lits.size() <= 3)
+    return amo_pairwise(logic, lits);
+
+  std::vector<literal_t> commanders;
+  literal_t amo = amo_groups(logic, lits, 3, commanders);
+  return logic.logic_and(amo, amo_commander(logic, commanders));
+}
+
+literal_t amo_product(Logic &logic, const std::vector<literal_t> &lits) {
+  if (lits.size() <= 4)
+    return amo_pairwise(logic, lits);
+
+  // at most one row and one column of the grid contain true literals
+  size_t cols = 1;
+  while (cols * cols < lits.size())
+    cols += 1;
+  size_t rows = (lits.size() + cols - 1) / cols;
+
+  std::vector<literal_t> row_ors;
+  for (size_t i = 0; i < rows; i++) {
+    std::vector<literal_t> row;
+    for (size_t j = i * cols; j < std::min((i + 1) * cols, lits.size()); j++)
+      row.push_back(lits[j]);
+    row_ors.push_back(logic.logic_any(row));
+  }
+
+  std::vector<literal_t> col_ors;
+  for (size_t j = 0; j < cols; j++) {
+    std::vector<literal_t> col;
+    for (size_t i = j; i < lits.size(); i += cols)
+      col.push_back(lits[i]);
+    col_ors.push_back(logic.logic_any(col));
+  }
+
+  return logic.logic_and(amo_product(logic, row_ors),
+                         amo_product(logic, col_ors));
+}
+
+literal_t amo_bimander(Logic &logic, const std::vector<literal_t> &lits) {
+  if (lits.size() <= 2)
+    return amo_pairwise(logic, lits);
+
+  std::vector<literal_t> groups;
+  literal_t amo = amo_groups(logic, lits, 2, groups);
+
+  // two different groups differ in some bit of their index, so it is enough
+  // to forbid true groups on both sides of each bit
+  std::vector<literal_t> bits;
+  for (size_t bit = 1; bit < groups.size(); bit *= 2) {
+    std::vector<literal_t> ones;
+    std::vector<literal_t> zeros;
+    for (size_t i = 0; i < groups.size(); i++)
+      ((i & bit) != 0 ? ones : zeros).push_back(groups[i]);
+    bits.push_back(logic.logic_not(
+        logic.logic_and(logic.logic_any(ones), logic.logic_any(zeros))));
+  }
+
+  return logic.logic_and(amo, logic.logic_all(bits));
+}
+
+literal_t Logic::logic_amo(const std::vector<literal_t> &lits,
+                           amo_encoding_t encoding) {
+  switch (encoding) {
+  case AMO_PAIRWISE:
+    return amo_pairwise(*this, lits);
+  case AMO_COMMANDER:
+    return amo_commander(*this, lits);
+  case AMO_PRODUCT:
+    return amo_product(*this, lits);
+  case AMO_BIMANDER:
+    return amo_bimander(*this, lits);
+  default:
+    return amo_ladder(*this, lits);
+  }
+}
+
 std::shared_ptr<Logic> Logic::join(const std::shared_ptr<Logic> &logic1,
                                    const std::shared_ptr<Logic> &logic2) {
   if (logic1 != logic2 && logic1 != BOOLEAN && logic2 != BOOLEAN)
@@ -64,6 +226,31 @@ public:
     literal_t lit3 = sign < 0 ? abs3 : -abs3;
     return lit3;
   }
+
+  virtual literal_t logic_atleast(const std::vector<literal_t> &lits,
+                                  int k) override {
+    for (literal_t lit : lits) {
+      assert(lit == FALSE || lit == TRUE);
+      if (lit == TRUE)
+        k -= 1;
+    }
+    return k <= 0 ? TRUE : FALSE;
+  }
+
+  virtual literal_t logic_amo(const std::vector<literal_t> &lits,
+                              amo_encoding_t) override {
+    return logic_atleast(lits, 2) == TRUE ? FALSE : TRUE;
+  }
+
+  virtual literal_t logic_exactly(const std::vector<literal_t> &lits,
+                                  int k) override {
+    for (literal_t lit : lits) {
+      assert(lit == FALSE || lit == TRUE);
+      if (lit == TRUE)
+        k -= 1;
+    }
+    return k == 0 ? TRUE : FALSE;
+  }
 };
 
 const std::shared_ptr<Logic> BOOLEAN = std::make_shared<Boolean>();
@@ -73,10 +260,351 @@ std::shared_ptr<Solver> Solver::create(const std::string &options) {
     return std::make_shared<MiniSat>();
   else if (options == "minisatsimp")
     return std::make_shared<MiniSatSimp>();
+  else if (options == "portfolio") {
+    unsigned int threads = std::thread::hardware_concurrency();
+    return std::make_shared<Portfolio>(std::min(std::max(threads, 2u), 8u));
+  }
 
   throw std::invalid_argument("invalid solver");
 }
 
+/**
+ * Adds the wall clock time of a solve call to the statistics when it goes
+ * out of scope.
+ */
+struct solve_timer_t {
+  Solver::stats_t &stats;
+  std::chrono::steady_clock::time_point start;
+
+  solve_timer_t(Solver::stats_t &stats)
+      : stats(stats), start(std::chrono::steady_clock::now()) {}
+
+  ~solve_timer_t() {
+    std::chrono::duration<double> time =
+        std::chrono::steady_clock::now() - start;
+    stats.solves += 1;
+    stats.last_solve_time = time.count();
+    stats.solve_time += time.count();
+  }
+};
+
+Solver::result_t Solver::solve(const std::vector<literal_t> &assumptions,
+                               const budget_t &budget) {
+  UASAT_TRACE_SCOPE("solve");
+  solve_timer_t timing(stats);
+  if (budget.seconds < 0)
+    return solve_limited(assumptions, budget.conflicts, budget.propagations);
+
+  // the timer can only interrupt while the search is running
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool done = false;
+  bool fired = false;
+  std::thread timer([&] {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!finished.wait_for(lock, std::chrono::duration<double>(budget.seconds),
+                           [&done] { return done; })) {
+      std::lock_guard<std::mutex> guard(interrupt_mutex);
+      interrupt_search();
+      fired = true;
+    }
+  });
+
+  result_t result = RESULT_UNKNOWN;
+  std::exception_ptr error;
+  try {
+    result = solve_limited(assumptions, budget.conflicts, budget.propagations);
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  finished.notify_one();
+  timer.join();
+
+  // the timer may fire after the search has finished, then its interrupt is
+  // withdrawn but those requested by the caller since then are kept
+  if (fired) {
+    std::lock_guard<std::mutex> guard(interrupt_mutex);
+    clear_interrupt_search();
+    if (interrupts_requested != interrupts_consumed)
+      interrupt_search();
+  }
+  if (error)
+    std::rethrow_exception(error);
+  return result;
+}
+
+void Solver::finish_search() {
+  std::lock_guard<std::mutex> guard(interrupt_mutex);
+  clear_interrupt_search();
+  interrupts_consumed = interrupts_requested;
+}
+
+void Solver::interrupt() {
+  std::lock_guard<std::mutex> guard(interrupt_mutex);
+  interrupts_requested += 1;
+  interrupt_search();
+}
+
+void Solver::clear_interrupt() {
+  std::lock_guard<std::mutex> guard(interrupt_mutex);
+  clear_interrupt_search();
+  interrupts_consumed = interrupts_requested;
+}
+
+std::future<Solver::result_t>
+Solver::solve_async(const std::vector<literal_t> &assumptions,
+                    const budget_t &budget) {
+  return std::async(std::launch::async, [this, assumptions, budget] {
+    return solve(assumptions, budget);
+  });
+}
+
+Solver::op_scope_t::op_scope_t(Solver &solver, stats_op_t op)
+    : solver(solver), outer(solver.active_op == OP_COUNT) {
+  if (outer) {
+    solver.active_op = op;
+    variables = solver.get_variables();
+    clauses = solver.stats.encoded_clauses;
+  }
+}
+
+Solver::op_scope_t::~op_scope_t() {
+  if (outer) {
+    op_stats_t &stats = solver.stats.ops[solver.active_op];
+    stats.calls += 1;
+    stats.variables += solver.get_variables() - variables;
+    stats.clauses += solver.stats.encoded_clauses - clauses;
+    solver.active_op = OP_COUNT;
+  }
+}
+
+void Solver::profile_push(const char *tag) {
+  profiled.push_back(profiler);
+  if (profiler)
+    profiler->push(tag, get_variables(), stats.encoded_clauses);
+}
+
+void Solver::profile_pop(const char *tag) {
+  if (profiled.empty())
+    return;
+
+  std::shared_ptr<Profiler> owner = profiled.back();
+  profiled.pop_back();
+  if (owner)
+    owner->pop(tag, get_variables(), stats.encoded_clauses);
+}
+
+const char *Solver::get_op_name(stats_op_t op) {
+  static const char *const names[OP_COUNT] = {"and",  "add",  "maj", "nary",
+                                              "sum",  "card", "amo"};
+  if (static_cast<unsigned int>(op) >= OP_COUNT)
+    throw std::invalid_argument("invalid operation kind");
+  return names[op];
+}
+
+Solver::stats_t Solver::get_stats() const {
+  stats_t result = stats;
+  result.variables = get_variables();
+  result.clauses = get_clauses();
+  return result;
+}
+
+std::ostream &operator<<(std::ostream &out, const Solver::stats_t &stats) {
+  out << "{\"solves\": " << stats.solves
+      << ", \"conflicts\": " << stats.conflicts
+      << ", \"decisions\": " << stats.decisions
+      << ", \"propagations\": " << stats.propagations
+      << ", \"restarts\": " << stats.restarts
+      << ", \"learnts\": " << stats.learnts
+      << ", \"learnt_literals\": " << stats.learnt_literals
+      << ", \"memory\": " << stats.memory
+      << ", \"solve_time\": " << stats.solve_time
+      << ", \"last_solve_time\": " << stats.last_solve_time
+      << ", \"variables\": " << stats.variables
+      << ", \"clauses\": " << stats.clauses
+      << ", \"encoded_clauses\": " << stats.encoded_clauses
+      << ", \"ops\": {";
+  for (int i = 0; i < Solver::OP_COUNT; i++) {
+    const Solver::op_stats_t &op = stats.ops[i];
+    out << (i != 0 ? ", \"" : "\"")
+        << Solver::get_op_name(static_cast<Solver::stats_op_t>(i))
+        << "\": {\"calls\": " << op.calls
+        << ", \"variables\": " << op.variables
+        << ", \"clauses\": " << op.clauses << "}";
+  }
+  return out << "}}";
+}
+
+void Solver::get_solution(const std::vector<literal_t> &lits,
+                          bitvec_t *vec) const {
+  assert(bitvec_t::get_length(vec) == lits.size());
+  for (size_t i = 0; i < lits.size(); i++)
+    bitvec_t::set_bit(vec, i, get_solution(lits[i]) == TRUE);
+}
+
+void Solver::add_blocking_clause(const std::vector<literal_t> &lits,
+                                 const bitvec_t *vec) {
+  assert(bitvec_t::get_length(vec) == lits.size());
+  for (size_t i = 0; i < lits.size(); i++)
+    buffer.push_back(bitvec_t::get_bit(vec, i) ? -lits[i] : lits[i]);
+  buffer_clause();
+}
+
+unsigned long
+Solver::enumerate(const std::vector<literal_t> &projection,
+                  const std::function<bool(const bitvec_t *values)> &callback,
+                  const std::vector<literal_t> &assumptions) {
+  std::unique_ptr<bitvec_t, void (*)(bitvec_t *)> values(
+      bitvec_t::create(projection.size()), bitvec_t::destroy);
+
+  unsigned long count = 0;
+  while (solve(assumptions)) {
+    get_solution(projection, values.get());
+    add_blocking_clause(projection, values.get());
+    count += 1;
+    if (!callback(values.get()))
+      break;
+  }
+
+  return count;
+}
+
+size_t Solver::gate_hash::operator()(const gate_t &gate) const {
+  size_t hash = gate.op;
+  hash = hash * 1000003 + static_cast<size_t>(gate.lit1);
+  hash = hash * 1000003 + static_cast<size_t>(gate.lit2);
+  hash = hash * 1000003 + static_cast<size_t>(gate.lit3);
+  return hash;
+}
+
+literal_t *Solver::find_gate(gate_op_t op, literal_t lit1, literal_t lit2,
+                             literal_t lit3) {
+  if (!hashing)
+    return nullptr;
+
+  literal_t &lit = gates[gate_t{op, lit1, lit2, lit3}];
+  if (lit != UNDEF)
+    hash_hits += 1;
+  else
+    hash_misses += 1;
+
+  return &lit;
+}
+
+literal_t *Solver::find_gate(const std::vector<literal_t> &lits) {
+  if (!hashing)
+    return nullptr;
+
+  literal_t &lit = nary_gates[lits];
+  if (lit != UNDEF)
+    hash_hits += 1;
+  else
+    hash_misses += 1;
+
+  return &lit;
+}
+
+void Solver::clear_gates() {
+  clear_hashed_gates();
+  hash_hits = 0;
+  hash_misses = 0;
+  definitions.clear();
+  required.clear();
+  defining = UNDEF;
+}
+
+void Solver::polarize_clause() {
+  size_t end = buffer.size();
+  size_t start = end - 1;
+  while (start > 0 && buffer[start - 1] != 0)
+    start -= 1;
+
+  if (defining != UNDEF) {
+    size_t var = std::abs(defining);
+    if (definitions.size() <= var)
+      definitions.resize(var + 1);
+    definition_t &def = definitions[var];
+
+    // the clauses with the negated output are needed for positive uses
+    bool positive = std::find(buffer.begin() + start, buffer.end(),
+                              -(literal_t)var) != buffer.end();
+    if (!(positive ? def.positive_emitted : def.negative_emitted)) {
+      std::vector<literal_t> &half = positive ? def.positive : def.negative;
+      half.insert(half.end(), buffer.begin() + start, buffer.end());
+      buffer.resize(start);
+      buffered -= 1;
+      return;
+    }
+  }
+
+  require_literals(buffer.data() + start, end - start);
+}
+
+void Solver::require_literals(const literal_t *lits, size_t size) {
+  // the buffer grows while the definitions are emitted, so copy them first
+  for (size_t i = 0; i < size; i++)
+    if (lits[i] != 0 && (size_t)std::abs(lits[i]) < definitions.size())
+      required.push_back(lits[i]);
+
+  while (!required.empty()) {
+    literal_t lit = required.back();
+    required.pop_back();
+
+    size_t var = std::abs(lit);
+    if (var >= definitions.size())
+      continue;
+
+    definition_t &def = definitions[var];
+    bool &emitted = lit > 0 ? def.positive_emitted : def.negative_emitted;
+    if (emitted)
+      continue;
+    emitted = true;
+
+    std::vector<literal_t> half;
+    half.swap(lit > 0 ? def.positive : def.negative);
+    for (literal_t lit2 : half) {
+      buffer.push_back(lit2);
+      if (lit2 == 0)
+        buffered += 1;
+      else if ((size_t)std::abs(lit2) != var)
+        required.push_back(lit2);
+    }
+  }
+}
+
+void Solver::require_all() {
+  for (size_t var = 1; var < definitions.size(); var++) {
+    literal_t lits[2] = {(literal_t)var, -(literal_t)var};
+    require_literals(lits, 2);
+  }
+}
+
+std::vector<literal_t> Solver::get_pending_variables() const {
+  std::vector<literal_t> vars;
+  for (size_t var = 1; var < definitions.size(); var++) {
+    const definition_t &def = definitions[var];
+    for (const std::vector<literal_t> *half : {&def.positive, &def.negative})
+      for (literal_t lit : *half)
+        if (lit != 0)
+          vars.push_back(std::abs(lit));
+  }
+
+  std::sort(vars.begin(), vars.end());
+  vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+  return vars;
+}
+
+void Solver::set_polarity_gates(bool enable) {
+  if (polarity_gates && !enable)
+    require_all();
+  polarity_gates = enable;
+}
+
 literal_t Solver::logic_and(literal_t lit1, literal_t lit2) {
   if (lit1 == FALSE || lit2 == FALSE)
     return FALSE;
@@ -89,10 +617,23 @@ literal_t Solver::logic_and(literal_t lit1, literal_t lit2) {
   else if (lit1 == logic_not(lit2))
     return FALSE;
 
+  if (lit1 > lit2)
+    std::swap(lit1, lit2);
+
+  literal_t *hashed = find_gate(GATE_AND, lit1, lit2);
+  if (hashed != nullptr && *hashed != UNDEF)
+    return *hashed;
+
+  op_scope_t scope(*this, OP_AND);
   literal_t lit3 = add_variable(false, false);
+  defining = lit3;
   add_clause(lit1, logic_not(lit3));
   add_clause(lit2, logic_not(lit3));
   add_clause(logic_not(lit1), logic_not(lit2), lit3);
+  defining = UNDEF;
+
+  if (hashed != nullptr)
+    *hashed = lit3;
   return lit3;
 }
 
@@ -110,12 +651,29 @@ literal_t Solver::logic_add(literal_t lit1, literal_t lit2) {
   else if (lit1 == logic_not(lit2))
     return TRUE;
 
+  // the sum changes sign with each negated input
+  bool negated = (lit1 < 0) != (lit2 < 0);
+  lit1 = std::abs(lit1);
+  lit2 = std::abs(lit2);
+  if (lit1 > lit2)
+    std::swap(lit1, lit2);
+
+  literal_t *hashed = find_gate(GATE_ADD, lit1, lit2);
+  if (hashed != nullptr && *hashed != UNDEF)
+    return negated ? logic_not(*hashed) : *hashed;
+
+  op_scope_t scope(*this, OP_ADD);
   literal_t lit3 = add_variable(false, false);
+  defining = lit3;
   add_clause(lit1, lit2, logic_not(lit3));
   add_clause(logic_not(lit1), lit2, lit3);
   add_clause(lit1, logic_not(lit2), lit3);
   add_clause(logic_not(lit1), logic_not(lit2), logic_not(lit3));
-  return lit3;
+  defining = UNDEF;
+
+  if (hashed != nullptr)
+    *hashed = lit3;
+  return negated ? logic_not(lit3) : lit3;
 }
 
 literal_t Solver::logic_maj(literal_t lit1, literal_t lit2, literal_t lit3) {
@@ -144,14 +702,317 @@ literal_t Solver::logic_maj(literal_t lit1, literal_t lit2, literal_t lit3) {
   else if (lit2 == logic_not(lit3))
     return lit1;
 
+  // sort by variables and use self-duality to make the first one positive
+  auto by_variable = [](literal_t a, literal_t b) {
+    return std::abs(a) < std::abs(b);
+  };
+  if (by_variable(lit2, lit1))
+    std::swap(lit1, lit2);
+  if (by_variable(lit3, lit2))
+    std::swap(lit2, lit3);
+  if (by_variable(lit2, lit1))
+    std::swap(lit1, lit2);
+
+  bool negated = lit1 < 0;
+  if (negated) {
+    lit1 = logic_not(lit1);
+    lit2 = logic_not(lit2);
+    lit3 = logic_not(lit3);
+  }
+
+  literal_t *hashed = find_gate(GATE_MAJ, lit1, lit2, lit3);
+  if (hashed != nullptr && *hashed != UNDEF)
+    return negated ? logic_not(*hashed) : *hashed;
+
+  op_scope_t scope(*this, OP_MAJ);
   literal_t lit4 = add_variable(false, false);
+  defining = lit4;
   add_clause(lit1, lit2, logic_not(lit4));
   add_clause(lit1, lit3, logic_not(lit4));
   add_clause(lit2, lit3, logic_not(lit4));
   add_clause(logic_not(lit1), logic_not(lit2), lit4);
   add_clause(logic_not(lit1), logic_not(lit3), lit4);
   add_clause(logic_not(lit2), logic_not(lit3), lit4);
-  return lit4;
+  defining = UNDEF;
+
+  if (hashed != nullptr)
+    *hashed = lit4;
+  return negated ? logic_not(lit4) : lit4;
+}
+
+literal_t Solver::nary_and(const std::vector<literal_t> &lits, bool negate) {
+  std::vector<literal_t> inputs;
+  inputs.reserve(lits.size());
+  for (literal_t lit : lits) {
+    if (negate)
+      lit = logic_not(lit);
+    if (lit == FALSE)
+      return FALSE;
+    else if (lit != TRUE)
+      inputs.push_back(lit);
+  }
+
+  if (!nary) {
+    literal_t result = TRUE;
+    for (literal_t lit : inputs)
+      result = logic_and(result, lit);
+    return result;
+  }
+
+  // sort by variables so that repeated and complementary inputs are adjacent
+  std::sort(inputs.begin(), inputs.end(), [](literal_t a, literal_t b) {
+    return std::abs(a) < std::abs(b) || (std::abs(a) == std::abs(b) && a < b);
+  });
+
+  size_t size = 0;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (size > 0 && inputs[size - 1] == inputs[i])
+      continue;
+    else if (size > 0 && inputs[size - 1] == logic_not(inputs[i]))
+      return FALSE;
+    inputs[size++] = inputs[i];
+  }
+  inputs.resize(size);
+
+  if (size == 0)
+    return TRUE;
+  else if (size == 1)
+    return inputs[0];
+  else if (size == 2)
+    return logic_and(inputs[0], inputs[1]);
+
+  literal_t *hashed = find_gate(inputs);
+  if (hashed != nullptr && *hashed != UNDEF)
+    return *hashed;
+
+  op_scope_t scope(*this, OP_NARY);
+  literal_t output = add_variable(false, false);
+  defining = output;
+  for (literal_t lit : inputs)
+    add_clause(lit, logic_not(output));
+
+  for (literal_t &lit : inputs)
+    lit = logic_not(lit);
+  inputs.push_back(output);
+  add_clause(inputs);
+  defining = UNDEF;
+
+  if (hashed != nullptr)
+    *hashed = output;
+  return output;
+}
+
+literal_t Solver::logic_all(const std::vector<literal_t> &lits) {
+  return nary_and(lits, false);
+}
+
+literal_t Solver::logic_any(const std::vector<literal_t> &lits) {
+  return logic_not(nary_and(lits, true));
+}
+
+literal_t Solver::logic_sum(const std::vector<literal_t> &lits) {
+  if (!nary)
+    return Logic::logic_sum(lits);
+
+  // adding up the pairs level by level gives a tree of logarithmic depth
+  std::vector<literal_t> level(lits);
+  if (level.empty())
+    return FALSE;
+  else if (level.size() == 1)
+    return level[0];
+
+  op_scope_t scope(*this, OP_SUM);
+
+  while (level.size() > 1) {
+    size_t size = 0;
+    for (size_t i = 0; i + 1 < level.size(); i += 2)
+      level[size++] = logic_add(level[i], level[i + 1]);
+    if (level.size() % 2 != 0)
+      level[size++] = level.back();
+    level.resize(size);
+  }
+
+  return level[0];
+}
+
+void Solver::add_reduced_clause(std::initializer_list<literal_t> lits) {
+  size_t size = buffer.size();
+  for (literal_t lit : lits) {
+    if (lit == TRUE) {
+      buffer.resize(size);
+      return;
+    } else if (lit != FALSE)
+      buffer.push_back(lit);
+  }
+  buffer_clause();
+}
+
+std::vector<literal_t>
+Solver::sequential_counter(const std::vector<literal_t> &lits, int k) {
+  // counts[j] is true if at least j + 1 of the literals seen so far are true,
+  // and it is defined by counts[j] | (lit & counts[j - 1]) in both directions
+  std::vector<literal_t> counts(k, literal_t(FALSE));
+  for (size_t i = 0; i < lits.size(); i++) {
+    literal_t lit = lits[i];
+    literal_t lower = TRUE;
+    int top = std::min(k, (int)i + 1);
+    for (int j = 0; j < top; j++) {
+      literal_t prev = counts[j];
+      if (prev == FALSE && lower == TRUE)
+        counts[j] = lit;
+      else {
+        literal_t next = add_variable(false, false);
+        defining = next;
+        add_reduced_clause({logic_not(prev), next});
+        add_reduced_clause({logic_not(lit), logic_not(lower), next});
+        add_reduced_clause({logic_not(next), prev, lit});
+        add_reduced_clause({logic_not(next), prev, lower});
+        defining = UNDEF;
+        counts[j] = next;
+      }
+      lower = prev;
+    }
+  }
+  return counts;
+}
+
+std::vector<literal_t> Solver::totalizer(const literal_t *lits, size_t size,
+                                         int k) {
+  if (size == 1)
+    return std::vector<literal_t>(1, lits[0]);
+
+  std::vector<literal_t> counts1 = totalizer(lits, size / 2, k);
+  std::vector<literal_t> counts2 =
+      totalizer(lits + size / 2, size - size / 2, k);
+
+  size_t size1 = counts1.size();
+  size_t size2 = counts2.size();
+  size_t size3 = std::min(size1 + size2, (size_t)k);
+
+  std::vector<literal_t> counts3(size3);
+  for (literal_t &lit : counts3)
+    lit = add_variable(false, false);
+
+  // the unary counts extended with TRUE at index 0 and FALSE at the end
+  auto get = [](const std::vector<literal_t> &counts, size_t i) {
+    if (i == 0)
+      return literal_t(TRUE);
+    return i <= counts.size() ? counts[i - 1] : literal_t(FALSE);
+  };
+
+  for (size_t i = 0; i <= size1; i++) {
+    for (size_t j = 0; j <= size2; j++) {
+      if (i + j > 0) {
+        defining = counts3[std::min(i + j, size3) - 1];
+        add_reduced_clause({logic_not(get(counts1, i)),
+                            logic_not(get(counts2, j)), defining});
+      }
+      if (i + j < size3) {
+        defining = counts3[i + j];
+        add_reduced_clause({get(counts1, i + 1), get(counts2, j + 1),
+                            logic_not(defining)});
+      }
+    }
+  }
+  defining = UNDEF;
+
+  return counts3;
+}
+
+std::vector<literal_t>
+Solver::sorting_network(const std::vector<literal_t> &lits, int k) {
+  size_t size = 1;
+  while (size < lits.size())
+    size *= 2;
+
+  // sorted in decreasing order, so padding with FALSE does not change the
+  // prefix we need, and the comparators are or and and gates
+  std::vector<literal_t> sorted(lits);
+  sorted.resize(size, literal_t(FALSE));
+
+  // iterative odd-even merge sort of Batcher
+  for (size_t p = 1; p < size; p *= 2)
+    for (size_t q = p; q > 0; q /= 2)
+      for (size_t j = q % p; j + q < size; j += 2 * q)
+        for (size_t i = 0; i < q && i + j + q < size; i++)
+          if ((i + j) / (2 * p) == (i + j + q) / (2 * p)) {
+            literal_t lit1 = sorted[i + j];
+            literal_t lit2 = sorted[i + j + q];
+            sorted[i + j] = logic_or(lit1, lit2);
+            sorted[i + j + q] = logic_and(lit1, lit2);
+          }
+
+  sorted.resize(k);
+  return sorted;
+}
+
+std::vector<literal_t> Solver::count_unary(const std::vector<literal_t> &lits,
+                                           int k) {
+  assert(0 < k && (size_t)k <= lits.size());
+
+  if (cardinality == CARD_SEQUENTIAL)
+    return sequential_counter(lits, k);
+  else if (cardinality == CARD_TOTALIZER)
+    return totalizer(lits.data(), lits.size(), k);
+  else
+    return sorting_network(lits, k);
+}
+
+literal_t Solver::logic_atleast(const std::vector<literal_t> &lits, int k) {
+  std::vector<literal_t> inputs;
+  for (literal_t lit : lits) {
+    if (lit == TRUE)
+      k -= 1;
+    else if (lit != FALSE)
+      inputs.push_back(lit);
+  }
+
+  if (k <= 0)
+    return TRUE;
+  else if ((size_t)k > inputs.size())
+    return FALSE;
+  else if (k == 1)
+    return logic_any(inputs);
+  else if ((size_t)k == inputs.size())
+    return logic_all(inputs);
+
+  op_scope_t scope(*this, OP_CARD);
+  return count_unary(inputs, k)[k - 1];
+}
+
+literal_t Solver::logic_exactly(const std::vector<literal_t> &lits, int k) {
+  std::vector<literal_t> inputs;
+  for (literal_t lit : lits) {
+    if (lit == TRUE)
+      k -= 1;
+    else if (lit != FALSE)
+      inputs.push_back(lit);
+  }
+
+  if (k < 0 || (size_t)k > inputs.size())
+    return FALSE;
+  else if (k == 0)
+    return logic_not(logic_any(inputs));
+  else if ((size_t)k == inputs.size())
+    return logic_all(inputs);
+
+  op_scope_t scope(*this, OP_CARD);
+  std::vector<literal_t> counts = count_unary(inputs, k + 1);
+  return logic_and(counts[k - 1], logic_not(counts[k]));
+}
+
+literal_t Solver::logic_amo(const std::vector<literal_t> &lits,
+                            amo_encoding_t encoding) {
+  std::vector<literal_t> inputs;
+  for (literal_t lit : lits)
+    if (lit != FALSE)
+      inputs.push_back(lit);
+
+  if (inputs.size() <= 1)
+    return TRUE;
+
+  op_scope_t scope(*this, OP_AMO);
+  return Logic::logic_amo(inputs, encoding != AMO_DEFAULT ? encoding : amo);
 }
 
 } // namespace uasat
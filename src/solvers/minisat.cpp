@@ -21,19 +21,16 @@
  */
 
 #include "minisat.hpp"
-#include "minisat/core/Solver.h"
+#include "minisatlit.hpp"
+#include "uasat/bitvec.hpp"
 #include "minisat/simp/SimpSolver.h"
+#include "minisat/utils/System.h"
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
 namespace uasat {
 
-inline literal_t var2gen(Minisat::Var var) { return var + 1; }
-
-inline Minisat::Lit gen2lit(literal_t lit) {
-  return Minisat::toLit(lit > 0 ? (lit << 1) - 2 : ((-lit) << 1) - 1);
-}
-
 MiniSat::MiniSat() { clear(); }
 
 MiniSat::~MiniSat() {}
@@ -45,49 +42,80 @@ void MiniSat::clear() {
     throw new std::logic_error("First literal of MiniSat is not 1");
   solver->addClause(gen2lit(lit));
   solvable = true;
+  buffer.clear();
+  buffered = 0;
+  failed.clear();
+  stats = stats_t();
+  clear_gates();
 }
 
 literal_t MiniSat::add_variable(bool decision, bool polarity) {
   return var2gen(solver->newVar(polarity, decision));
 }
 
-void MiniSat::add_clause(const std::vector<literal_t> &clause) {
-  if (solvable) {
-    Minisat::vec<Minisat::Lit> vec(clause.size());
-    for (size_t i = 0; i < clause.size(); i++)
-      vec[i] = gen2lit(clause[i]);
+void MiniSat::push_clauses(const std::vector<literal_t> &clauses) {
+  assert(clauses.empty() || clauses.back() == 0);
 
-    solvable = solver->addClause(vec);
+  // the literals are translated while copied into the only buffer that
+  // addClause_ accepts, which keeps its capacity between the clauses
+  Minisat::vec<Minisat::Lit> vec;
+  const literal_t *lits = clauses.data();
+  const literal_t *end = lits + clauses.size();
+  while (solvable && lits != end) {
+    for (; *lits != 0; lits++)
+      vec.push(gen2lit(*lits));
+    lits++;
+
+    solvable = solver->addClause_(vec);
+    vec.clear();
   }
 }
 
-void MiniSat::add_clause(literal_t lit1) {
-  if (solvable)
-    solvable = solver->addClause(gen2lit(lit1));
+unsigned long MiniSat::get_variables() const {
+  return std::max(solver->nVars(), 1) - 1;
 }
 
-void MiniSat::add_clause(literal_t lit1, literal_t lit2) {
-  if (solvable)
-    solvable = solver->addClause(gen2lit(lit1), gen2lit(lit2));
+unsigned long MiniSat::get_clauses() const {
+  return solver->nClauses() + buffered;
 }
 
-void MiniSat::add_clause(literal_t lit1, literal_t lit2, literal_t lit3) {
-  if (solvable)
-    solvable = solver->addClause(gen2lit(lit1), gen2lit(lit2), gen2lit(lit3));
+Solver::stats_t MiniSat::get_stats() const {
+  stats_t result = Solver::get_stats();
+  add_stats(*solver, result);
+  result.memory = Minisat::memUsedPeak();
+  return result;
 }
 
-unsigned long MiniSat::get_variables() const {
-  return std::max(solver->nVars(), 1) - 1;
-}
+Solver::result_t
+MiniSat::solve_limited(const std::vector<literal_t> &assumptions,
+                       long conflicts, long propagations) {
+  prepare_solve(assumptions);
+  if (!solvable)
+    return RESULT_UNSAT;
+
+  Minisat::vec<Minisat::Lit> vec(assumptions.size());
+  for (size_t i = 0; i < assumptions.size(); i++)
+    vec[i] = gen2lit(assumptions[i]);
 
-unsigned long MiniSat::get_clauses() const { return solver->nClauses(); }
+  set_budget(*solver, conflicts, propagations);
+  Minisat::lbool result = solver->solveLimited(vec);
+  finish_search();
+  if (result == l_True)
+    return RESULT_SAT;
+  else if (result == l_Undef)
+    return RESULT_UNKNOWN;
 
-bool MiniSat::solve() {
+  // the problem is unsatisfiable only if it fails without assumptions
+  solvable = solver->okay();
   if (solvable)
-    solvable = solver->solve();
-  return solvable;
+    get_failed(*solver, failed);
+  return RESULT_UNSAT;
 }
 
+void MiniSat::interrupt_search() { solver->interrupt(); }
+
+void MiniSat::clear_interrupt_search() { solver->clearInterrupt(); }
+
 literal_t MiniSat::get_solution(literal_t lit) const {
   assert(solvable);
 
@@ -95,6 +123,14 @@ literal_t MiniSat::get_solution(literal_t lit) const {
   return value.isTrue() ? TRUE : value.isFalse() ? FALSE : UNDEF;
 }
 
+void MiniSat::get_solution(const std::vector<literal_t> &lits,
+                           bitvec_t *vec) const {
+  assert(solvable);
+  assert(bitvec_t::get_length(vec) == lits.size());
+
+  get_model(*solver, lits, vec);
+}
+
 MiniSatSimp::MiniSatSimp() { clear(); }
 
 MiniSatSimp::~MiniSatSimp() {}
@@ -107,6 +143,11 @@ void MiniSatSimp::clear() {
   solver->addClause(gen2lit(lit));
   solvable = true;
   simplified = false;
+  buffer.clear();
+  buffered = 0;
+  failed.clear();
+  stats = stats_t();
+  clear_gates();
 }
 
 literal_t MiniSatSimp::add_variable(bool decision, bool polarity) {
@@ -116,48 +157,84 @@ literal_t MiniSatSimp::add_variable(bool decision, bool polarity) {
   return var2gen(var);
 }
 
-void MiniSatSimp::add_clause(const std::vector<literal_t> &clause) {
-  if (solvable) {
-    Minisat::vec<Minisat::Lit> vec(clause.size());
-    for (size_t i = 0; i < clause.size(); i++)
-      vec[i] = gen2lit(clause[i]);
+void MiniSatSimp::push_clauses(const std::vector<literal_t> &clauses) {
+  assert(clauses.empty() || clauses.back() == 0);
+
+  // the literals are translated while copied into the only buffer that
+  // addClause_ accepts, which keeps its capacity between the clauses
+  Minisat::vec<Minisat::Lit> vec;
+  const literal_t *lits = clauses.data();
+  const literal_t *end = lits + clauses.size();
+  while (solvable && lits != end) {
+    for (; *lits != 0; lits++)
+      vec.push(gen2lit(*lits));
+    lits++;
 
-    solvable = solver->addClause(vec);
+    solvable = solver->addClause_(vec);
+    vec.clear();
   }
 }
 
-void MiniSatSimp::add_clause(literal_t lit1) {
-  if (solvable)
-    solvable = solver->addClause(gen2lit(lit1));
+unsigned long MiniSatSimp::get_variables() const {
+  return std::max(solver->nVars(), 1) - 1;
 }
 
-void MiniSatSimp::add_clause(literal_t lit1, literal_t lit2) {
-  if (solvable)
-    solvable = solver->addClause(gen2lit(lit1), gen2lit(lit2));
+unsigned long MiniSatSimp::get_clauses() const {
+  return solver->nClauses() + buffered;
 }
 
-void MiniSatSimp::add_clause(literal_t lit1, literal_t lit2, literal_t lit3) {
-  if (solvable)
-    solvable = solver->addClause(gen2lit(lit1), gen2lit(lit2), gen2lit(lit3));
+Solver::stats_t MiniSatSimp::get_stats() const {
+  stats_t result = Solver::get_stats();
+  add_stats(*solver, result);
+  result.memory = Minisat::memUsedPeak();
+  return result;
 }
 
-unsigned long MiniSatSimp::get_variables() const {
-  return std::max(solver->nVars(), 1) - 1;
-}
+Solver::result_t
+MiniSatSimp::solve_limited(const std::vector<literal_t> &assumptions,
+                           long conflicts, long propagations) {
+  prepare_solve(assumptions);
+  if (!solvable)
+    return RESULT_UNSAT;
 
-unsigned long MiniSatSimp::get_clauses() const { return solver->nClauses(); }
+  // the assumed variables must survive the elimination
+  Minisat::vec<Minisat::Lit> vec(assumptions.size());
+  for (size_t i = 0; i < assumptions.size(); i++) {
+    vec[i] = gen2lit(assumptions[i]);
+    Minisat::Var var = Minisat::var(vec[i]);
+    if (solver->isEliminated(var))
+      throw std::invalid_argument("assumption variable is eliminated");
+    solver->setFrozen(var, true);
+  }
 
-bool MiniSatSimp::solve() {
-  if (solvable) {
-    if (!simplified) {
-      solver->eliminate(true);
-      solvable = solver->solve(true, true);
-    } else
-      solvable = solver->solve(false, false);
+  if (!simplified) {
+    // the pending definition halves are emitted over these variables later
+    for (literal_t lit : get_pending_variables())
+      solver->setFrozen(Minisat::var(gen2lit(lit)), true);
+    solver->eliminate(true);
+    simplified = true;
+    // eliminated gate variables cannot be reused in new clauses
+    clear_hashed_gates();
   }
-  return solvable;
+
+  set_budget(*solver, conflicts, propagations);
+  Minisat::lbool result = solver->solveLimited(vec, false, false);
+  finish_search();
+  if (result == l_True)
+    return RESULT_SAT;
+  else if (result == l_Undef)
+    return RESULT_UNKNOWN;
+
+  solvable = solver->okay();
+  if (solvable)
+    get_failed(*solver, failed);
+  return RESULT_UNSAT;
 }
 
+void MiniSatSimp::interrupt_search() { solver->interrupt(); }
+
+void MiniSatSimp::clear_interrupt_search() { solver->clearInterrupt(); }
+
 literal_t MiniSatSimp::get_solution(literal_t lit) const {
   assert(solvable);
 
@@ -165,4 +242,12 @@ literal_t MiniSatSimp::get_solution(literal_t lit) const {
   return value.isTrue() ? TRUE : value.isFalse() ? FALSE : UNDEF;
 }
 
+void MiniSatSimp::get_solution(const std::vector<literal_t> &lits,
+                               bitvec_t *vec) const {
+  assert(solvable);
+  assert(bitvec_t::get_length(vec) == lits.size());
+
+  get_model(*solver, lits, vec);
+}
+
 } // namespace uasat
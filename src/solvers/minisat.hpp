@@ -39,22 +39,26 @@ protected:
   std::unique_ptr<Minisat::Solver> solver;
   bool solvable;
 
+  void push_clauses(const std::vector<literal_t> &clauses) override;
+  result_t solve_limited(const std::vector<literal_t> &assumptions,
+                         long conflicts, long propagations) override;
+  void interrupt_search() override;
+  void clear_interrupt_search() override;
+
 public:
   MiniSat();
   ~MiniSat() override;
   void clear() override;
 
   literal_t add_variable(bool decision, bool polarity) override;
-  void add_clause(const std::vector<literal_t> &clause) override;
-  void add_clause(literal_t lit1) override;
-  void add_clause(literal_t lit1, literal_t lit2) override;
-  void add_clause(literal_t lit1, literal_t lit2, literal_t lit3) override;
 
   unsigned long get_variables() const override;
   unsigned long get_clauses() const override;
+  stats_t get_stats() const override;
 
-  bool solve() override;
   literal_t get_solution(literal_t lit) const override;
+  void get_solution(const std::vector<literal_t> &lits,
+                    bitvec_t *vec) const override;
 };
 
 class MiniSatSimp : public Solver {
@@ -63,24 +67,28 @@ protected:
   bool solvable;
   bool simplified;
 
+  void push_clauses(const std::vector<literal_t> &clauses) override;
+  result_t solve_limited(const std::vector<literal_t> &assumptions,
+                         long conflicts, long propagations) override;
+  void interrupt_search() override;
+  void clear_interrupt_search() override;
+
 public:
   MiniSatSimp();
   ~MiniSatSimp() override;
   void clear() override;
 
   literal_t add_variable(bool decision, bool polarity) override;
-  void add_clause(const std::vector<literal_t> &clause) override;
-  void add_clause(literal_t lit1) override;
-  void add_clause(literal_t lit1, literal_t lit2) override;
-  void add_clause(literal_t lit1, literal_t lit2, literal_t lit3) override;
 
   unsigned long get_variables() const override;
   unsigned long get_clauses() const override;
+  stats_t get_stats() const override;
 
-  bool solve() override;
   literal_t get_solution(literal_t lit) const override;
+  void get_solution(const std::vector<literal_t> &lits,
+                    bitvec_t *vec) const override;
 };
 
 } // namespace uasat
 
-#endif // UASAT_SOLVER_HPP
+#endif // UASAT_MINISAT_HPP
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UASAT_MINISATLIT_HPP
+#define UASAT_MINISATLIT_HPP
+
+#include "uasat/bitvec.hpp"
+#include "uasat/solver.hpp"
+#include "minisat/core/Solver.h"
+#include <algorithm>
+#include <vector>
+
+namespace uasat {
+
+inline literal_t var2gen(Minisat::Var var) { return var + 1; }
+
+/**
+ * Maps the literal +v or -v to 2 * (v - 1) + sign, the index of the MiniSat
+ * literal. The sign mask is 0 or -1, so this compiles without branches.
+ */
+inline Minisat::Lit gen2lit(literal_t lit) {
+  literal_t sign = lit >> (8 * sizeof(literal_t) - 1);
+  return Minisat::toLit((((lit ^ sign) - sign) << 1) - 2 - sign);
+}
+
+inline literal_t lit2gen(Minisat::Lit lit) {
+  literal_t var = var2gen(Minisat::var(lit));
+  return Minisat::sign(lit) ? -var : var;
+}
+
+/**
+ * Copies the failed assumptions from the final conflict clause, which
+ * contains their negations.
+ */
+inline void get_failed(const Minisat::Solver &solver,
+                       std::vector<literal_t> &failed) {
+  for (int i = 0; i < solver.conflict.size(); i++)
+    failed.push_back(-lit2gen(solver.conflict[i]));
+}
+
+/**
+ * Sets the conflict and propagation budgets of the next solveLimited call
+ * relative to the current counters, negative values meaning no limit.
+ */
+inline void set_budget(Minisat::Solver &solver, long conflicts,
+                       long propagations) {
+  solver.budgetOff();
+  if (conflicts >= 0)
+    solver.setConfBudget(conflicts);
+  if (propagations >= 0)
+    solver.setPropBudget(propagations);
+}
+
+/**
+ * Adds the search counters of the solver to the statistics.
+ */
+inline void add_stats(const Minisat::Solver &solver, Solver::stats_t &stats) {
+  stats.conflicts += solver.conflicts;
+  stats.decisions += solver.decisions;
+  stats.propagations += solver.propagations;
+  stats.restarts += solver.starts;
+  stats.learnts += solver.nLearnts();
+  stats.learnt_literals += solver.learnts_literals;
+}
+
+/**
+ * Copies the model values of the given literals into the packed vector,
+ * collecting the bits into whole blocks.
+ */
+inline void get_model(const Minisat::Solver &solver,
+                      const std::vector<literal_t> &lits, bitvec_t *vec) {
+  for (size_t block = 0; block * 64 < lits.size(); block++) {
+    size_t size = std::min(lits.size() - block * 64, size_t(64));
+    const literal_t *source = lits.data() + block * 64;
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++)
+      if (solver.modelValue(gen2lit(source[i])).isTrue())
+        value |= uint64_t(1) << i;
+    bitvec_t::set_block(vec, block, value);
+  }
+}
+
+} // namespace uasat
+
+#endif // UASAT_MINISATLIT_HPP
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "portfolio.hpp"
+#include "minisatlit.hpp"
+#include "uasat/bitvec.hpp"
+#include "minisat/simp/SimpSolver.h"
+#include "minisat/utils/System.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace uasat {
+
+/**
+ * The configurations of the portfolio instances, the first one is plain
+ * MiniSat. Larger portfolios repeat them with different random seeds.
+ */
+const struct portfolio_config_t {
+  bool simplify;
+  bool luby_restart;
+  int phase_saving;
+  int ccmin_mode;
+  double random_var_freq;
+  bool rnd_init_act;
+} PORTFOLIO_CONFIGS[] = {
+    {false, true, 2, 2, 0.0, false},  {true, true, 2, 2, 0.0, false},
+    {false, false, 2, 2, 0.0, false}, {true, true, 0, 2, 0.01, false},
+    {false, true, 1, 1, 0.02, true},  {true, false, 2, 1, 0.01, true},
+    {false, true, 0, 0, 0.05, true},  {true, false, 1, 2, 0.02, false},
+};
+
+Portfolio::Portfolio(size_t size) : size(size) {
+  if (size < 1)
+    throw std::invalid_argument("invalid portfolio size");
+  clear();
+}
+
+Portfolio::~Portfolio() {}
+
+void Portfolio::clear() {
+  solvers.clear();
+  simps.clear();
+
+  size_t count = sizeof(PORTFOLIO_CONFIGS) / sizeof(PORTFOLIO_CONFIGS[0]);
+  for (size_t i = 0; i < size; i++) {
+    const portfolio_config_t &config = PORTFOLIO_CONFIGS[i % count];
+    Minisat::SimpSolver *simp = nullptr;
+    if (config.simplify) {
+      simp = new Minisat::SimpSolver();
+      solvers.emplace_back(simp);
+    } else
+      solvers.emplace_back(new Minisat::Solver());
+    simps.push_back(simp);
+
+    Minisat::Solver &solver = *solvers.back();
+    solver.luby_restart = config.luby_restart;
+    solver.phase_saving = config.phase_saving;
+    solver.ccmin_mode = config.ccmin_mode;
+    solver.random_var_freq = config.random_var_freq;
+    solver.rnd_init_act = config.rnd_init_act;
+    if (i > 0)
+      solver.random_seed += 1000003.0 * i;
+
+    // the variable methods of SimpSolver are not virtual
+    literal_t lit = var2gen(simp != nullptr ? simp->newVar() : solver.newVar());
+    if (lit != TRUE)
+      throw new std::logic_error("First literal of MiniSat is not 1");
+    solver.addClause(gen2lit(lit));
+  }
+
+  winner = 0;
+  solvable = true;
+  simplified = false;
+  buffer.clear();
+  buffered = 0;
+  failed.clear();
+  stats = stats_t();
+  clear_gates();
+}
+
+literal_t Portfolio::add_variable(bool decision, bool polarity) {
+  Minisat::Var var = 0;
+  for (size_t i = 0; i < size; i++) {
+    if (simps[i] != nullptr) {
+      var = simps[i]->newVar(polarity, decision);
+      if (decision)
+        simps[i]->setFrozen(var, true);
+    } else
+      var = solvers[i]->newVar(polarity, decision);
+  }
+  return var2gen(var);
+}
+
+void Portfolio::push_clauses(const std::vector<literal_t> &clauses) {
+  assert(clauses.empty() || clauses.back() == 0);
+
+  // addClause_ modifies its argument, so each instance gets a copy
+  Minisat::vec<Minisat::Lit> vec;
+  Minisat::vec<Minisat::Lit> copy;
+  const literal_t *lits = clauses.data();
+  const literal_t *end = lits + clauses.size();
+  while (solvable && lits != end) {
+    for (; *lits != 0; lits++)
+      vec.push(gen2lit(*lits));
+    lits++;
+
+    for (size_t i = 0; i < size; i++) {
+      vec.copyTo(copy);
+      solvable = solvers[i]->addClause_(copy) && solvable;
+    }
+    vec.clear();
+  }
+}
+
+unsigned long Portfolio::get_variables() const {
+  return std::max(solvers[0]->nVars(), 1) - 1;
+}
+
+unsigned long Portfolio::get_clauses() const {
+  return solvers[0]->nClauses() + buffered;
+}
+
+Solver::stats_t Portfolio::get_stats() const {
+  // the work of all instances is counted
+  stats_t result = Solver::get_stats();
+  for (size_t i = 0; i < size; i++)
+    add_stats(*solvers[i], result);
+  result.memory = Minisat::memUsedPeak();
+  return result;
+}
+
+Solver::result_t
+Portfolio::solve_limited(const std::vector<literal_t> &assumptions,
+                         long conflicts, long propagations) {
+  prepare_solve(assumptions);
+  if (!solvable)
+    return RESULT_UNSAT;
+
+  // the assumed variables must survive the elimination
+  Minisat::vec<Minisat::Lit> vec(assumptions.size());
+  for (size_t i = 0; i < assumptions.size(); i++) {
+    vec[i] = gen2lit(assumptions[i]);
+    Minisat::Var var = Minisat::var(vec[i]);
+    for (Minisat::SimpSolver *simp : simps) {
+      if (simp == nullptr)
+        continue;
+      if (simp->isEliminated(var))
+        throw std::invalid_argument("assumption variable is eliminated");
+      simp->setFrozen(var, true);
+    }
+  }
+
+  // the simplifying instances eliminate on their own thread the first time
+  bool simplify = !simplified;
+  if (simplify) {
+    simplified = true;
+    // the pending definition halves are emitted over these variables later
+    std::vector<literal_t> pending = get_pending_variables();
+    for (Minisat::SimpSolver *simp : simps)
+      if (simp != nullptr)
+        for (literal_t lit : pending)
+          simp->setFrozen(Minisat::var(gen2lit(lit)), true);
+    // eliminated gate variables cannot be reused in new clauses
+    if (std::count(simps.begin(), simps.end(), nullptr) < int(size))
+      clear_hashed_gates();
+  }
+
+  std::atomic<int> first(-1);
+  std::vector<Minisat::lbool> results(size);
+  std::vector<std::exception_ptr> errors(size);
+  auto work = [&](size_t index) {
+    try {
+      set_budget(*solvers[index], conflicts, propagations);
+      Minisat::SimpSolver *simp = simps[index];
+      results[index] = simp != nullptr
+                           ? simp->solveLimited(vec, simplify, true)
+                           : solvers[index]->solveLimited(vec);
+      int expected = -1;
+      if (results[index] != l_Undef &&
+          first.compare_exchange_strong(expected, int(index)))
+        for (size_t i = 0; i < size; i++)
+          if (i != index)
+            solvers[i]->interrupt();
+    } catch (...) {
+      errors[index] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < size; i++)
+    workers.emplace_back(work, i);
+  work(0);
+  for (std::thread &worker : workers)
+    worker.join();
+
+  finish_search();
+  for (const std::exception_ptr &error : errors)
+    if (error)
+      std::rethrow_exception(error);
+
+  // every instance ran out of budget or was interrupted from outside
+  if (first < 0)
+    return RESULT_UNKNOWN;
+
+  winner = size_t(first.load());
+  if (results[winner] == l_True)
+    return RESULT_SAT;
+
+  solvable = solvers[winner]->okay();
+  if (solvable)
+    get_failed(*solvers[winner], failed);
+  return RESULT_UNSAT;
+}
+
+void Portfolio::interrupt_search() {
+  for (size_t i = 0; i < size; i++)
+    solvers[i]->interrupt();
+}
+
+void Portfolio::clear_interrupt_search() {
+  for (size_t i = 0; i < size; i++)
+    solvers[i]->clearInterrupt();
+}
+
+literal_t Portfolio::get_solution(literal_t lit) const {
+  assert(solvable);
+
+  Minisat::lbool value = solvers[winner]->modelValue(gen2lit(lit));
+  return value.isTrue() ? TRUE : value.isFalse() ? FALSE : UNDEF;
+}
+
+void Portfolio::get_solution(const std::vector<literal_t> &lits,
+                             bitvec_t *vec) const {
+  assert(solvable);
+  assert(bitvec_t::get_length(vec) == lits.size());
+  get_model(*solvers[winner], lits, vec);
+}
+
+} // namespace uasat
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UASAT_PORTFOLIO_HPP
+#define UASAT_PORTFOLIO_HPP
+
+#include "uasat/solver.hpp"
+#include <memory>
+#include <vector>
+
+namespace Minisat {
+class Solver;
+class SimpSolver;
+} // namespace Minisat
+
+namespace uasat {
+
+class Portfolio : public Solver {
+protected:
+  size_t size;
+  std::vector<std::unique_ptr<Minisat::Solver>> solvers;
+  std::vector<Minisat::SimpSolver *> simps; // nullptr if not simplifying
+  size_t winner;
+  bool solvable;
+  bool simplified;
+
+  void push_clauses(const std::vector<literal_t> &clauses) override;
+  result_t solve_limited(const std::vector<literal_t> &assumptions,
+                         long conflicts, long propagations) override;
+  void interrupt_search() override;
+  void clear_interrupt_search() override;
+
+public:
+  /**
+   * Creates a portfolio of the given number of differently configured MiniSat
+   * instances, which receive the same variables and clauses. Each solve call
+   * runs all of them on separate threads, and the first answer wins.
+   */
+  Portfolio(size_t size);
+  ~Portfolio() override;
+  void clear() override;
+
+  literal_t add_variable(bool decision, bool polarity) override;
+
+  unsigned long get_variables() const override;
+  unsigned long get_clauses() const override;
+  stats_t get_stats() const override;
+
+  literal_t get_solution(literal_t lit) const override;
+  void get_solution(const std::vector<literal_t> &lits,
+                    bitvec_t *vec) const override;
+};
+
+} // namespace uasat
+
+#endif // UASAT_PORTFOLIO_HPP
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uasat/symmetry.hpp"
+#include "uasat/tensor.hpp"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace uasat {
+
+Symmetry::Symmetry(int size, const std::vector<int> &axes,
+                   generators_t generators)
+    : axes(axes) {
+  if (size < 0)
+    throw std::invalid_argument("invalid symmetry size");
+  if (generators == COMPLETE && size > MAX_COMPLETE_SIZE)
+    throw std::invalid_argument("complete symmetry is too large");
+
+  std::vector<int> perm(size);
+  std::iota(perm.begin(), perm.end(), 0);
+
+  if (generators == COMPLETE) {
+    // the identity is skipped, it gives no constraint
+    while (std::next_permutation(perm.begin(), perm.end()))
+      perms.push_back(perm);
+  } else {
+    for (int i = 0; i < size; i++)
+      for (int j = i + 1; j < size; j++) {
+        if (generators == ADJACENT && j != i + 1)
+          break;
+        std::swap(perm[i], perm[j]);
+        perms.push_back(perm);
+        std::swap(perm[i], perm[j]);
+      }
+  }
+}
+
+Symmetry::Symmetry(const std::vector<int> &axes,
+                   const std::vector<std::vector<int>> &perms)
+    : axes(axes), perms(perms) {}
+
+Tensor Symmetry::lex_leader(const Tensor &elem) const {
+  Tensor source = elem.materialize();
+
+  std::vector<Tensor> leqs;
+  leqs.reserve(perms.size());
+  for (const std::vector<int> &perm : perms)
+    leqs.push_back(source.lex_leq(source.permute(axes, perm)));
+
+  if (leqs.empty())
+    return Tensor::constant({}, true);
+
+  return Tensor::stack(leqs).fold_all();
+}
+
+} // namespace uasat
@@ -21,12 +21,25 @@
  */
 
 #include "uasat/tensor.hpp"
+#include "uasat/bitvec.hpp"
+#include "uasat/profile.hpp"
+#include "uasat/trace.hpp"
+#include <algorithm>
 #include <cassert>
 #include <limits>
 #include <stdexcept>
 
 namespace uasat {
 
+/**
+ * Returns the shape of the result of folding along the first axis.
+ */
+std::vector<int> get_folded_shape(const std::vector<int> &shape) {
+  if (shape.empty())
+    return shape;
+  return std::vector<int>(shape.begin() + 1, shape.end());
+}
+
 class View {
 public:
   size_t offset = 0;
@@ -89,79 +102,245 @@ size_t get_storage_size(const std::vector<int> &shape) {
   return size;
 }
 
+std::vector<size_t> get_default_strides(const std::vector<int> &shape) {
+  std::vector<size_t> strides(shape.size());
+  size_t size = 1;
+  for (size_t axis = 0; axis < shape.size(); axis++) {
+    strides[axis] = size;
+    size *= shape[axis];
+  }
+  return strides;
+}
+
+View get_view(const std::vector<int> &shape,
+              const std::vector<size_t> &strides) {
+  assert(shape.size() == strides.size());
+
+  View view;
+  for (size_t axis = 0; axis < shape.size(); axis++)
+    view.add(shape[axis], strides[axis]);
+  return view;
+}
+
+std::shared_ptr<bitvec_t> create_bits(size_t size) {
+  return std::shared_ptr<bitvec_t>(bitvec_t::create(size), bitvec_t::destroy);
+}
+
+/**
+ * Packs a sequence of values into consecutive blocks of a bit vector, so the
+ * vector is written a word at a time.
+ */
+class BitWriter {
+public:
+  bitvec_t *vec;
+  uint64_t block = 0;
+  uint64_t word = 0;
+  unsigned int pos = 0;
+
+  BitWriter(bitvec_t *vec) : vec(vec) {}
+
+  void push(bool value) {
+    word |= uint64_t(value) << pos;
+    if (++pos == 64) {
+      bitvec_t::set_block(vec, block++, word);
+      word = 0;
+      pos = 0;
+    }
+  }
+
+  /**
+   * Writes out the last partial block, must be called after the last value.
+   */
+  void flush() {
+    if (pos != 0)
+      bitvec_t::set_block(vec, block, word);
+  }
+};
+
+/**
+ * Collects the bits of the given strided view of the source starting at the
+ * given offset into a new bit vector in the default order.
+ */
+std::shared_ptr<bitvec_t> gather_bits(const bitvec_t *src, size_t offset,
+                                      const std::vector<int> &shape,
+                                      const std::vector<size_t> &strides) {
+  std::shared_ptr<bitvec_t> bits = create_bits(get_storage_size(shape));
+  BitWriter writer(bits.get());
+  View view = get_view(shape, strides);
+  do {
+    writer.push(bitvec_t::get_bit(src, offset + view.offset));
+  } while (view.next());
+  writer.flush();
+
+  return bits;
+}
+
 Tensor::Tensor(const std::shared_ptr<Logic> &logic,
                const std::vector<int> &shape)
-    : logic(logic), shape(shape), storage(get_storage_size(shape)) {}
+    : logic(logic), shape(shape),
+      storage(std::make_shared<std::vector<literal_t>>(
+          get_storage_size(shape))) {}
+
+Tensor::Tensor(const std::shared_ptr<Logic> &logic,
+               const std::vector<int> &shape,
+               const std::shared_ptr<std::vector<literal_t>> &storage,
+               const std::vector<size_t> &strides)
+    : logic(logic), shape(shape), storage(storage), strides(strides) {
+  if (strides.empty())
+    return;
+  assert(strides.size() == shape.size());
+
+  // a view of the whole storage in the default order is not a view at all
+  if (get_storage_size(shape) != storage->size())
+    return;
+  std::vector<size_t> strides2 = get_default_strides(shape);
+  for (size_t axis = 0; axis < shape.size(); axis++)
+    if (shape[axis] != 1 && strides[axis] != strides2[axis])
+      return;
+  this->strides.clear();
+}
+
+Tensor::Tensor(const std::vector<int> &shape,
+               const std::shared_ptr<bitvec_t> &bits)
+    : logic(BOOLEAN), shape(shape), bits(bits) {
+  assert(bitvec_t::get_length(bits.get()) == get_storage_size(shape));
+}
+
+Tensor Tensor::unpack() const {
+  if (bits == nullptr)
+    return *this;
+
+  Tensor tensor(BOOLEAN, shape);
+  for (size_t index = 0; index < tensor.storage->size(); index++)
+    (*tensor.storage)[index] =
+        bitvec_t::get_bit(bits.get(), index) ? Logic::TRUE : Logic::FALSE;
+
+  return tensor;
+}
+
+Tensor Tensor::pack() const {
+  if (logic != BOOLEAN || bits != nullptr)
+    return *this;
+
+  Tensor source = materialize();
+  std::shared_ptr<bitvec_t> bits2 = create_bits(source.storage->size());
+  BitWriter writer(bits2.get());
+  for (literal_t lit : *source.storage) {
+    assert(lit == Logic::TRUE || lit == Logic::FALSE);
+    writer.push(lit == Logic::TRUE);
+  }
+  writer.flush();
+
+  return Tensor(shape, bits2);
+}
+
+std::vector<size_t> Tensor::get_strides() const {
+  return strides.empty() ? get_default_strides(shape) : strides;
+}
+
+void Tensor::detach() {
+  if (bits != nullptr) {
+    if (bits.use_count() > 1) {
+      std::shared_ptr<bitvec_t> bits2 =
+          create_bits(bitvec_t::get_length(bits.get()));
+      bitvec_t::copy(bits2.get(), bits.get());
+      bits = bits2;
+    }
+  } else if (!strides.empty())
+    *this = materialize();
+  else if (storage.use_count() > 1)
+    storage = std::make_shared<std::vector<literal_t>>(*storage);
+}
 
 size_t
 Tensor::__very_slow_get_index(const std::vector<int> &coordinates) const {
   if (coordinates.size() != shape.size())
     throw std::invalid_argument("invalid number of coordinates");
 
+  std::vector<size_t> strides2 = get_strides();
   size_t index = 0;
-  size_t size = 1;
   for (size_t axis = 0; axis < coordinates.size(); axis++) {
     if (coordinates[axis] < 0 || coordinates[axis] >= shape[axis])
       throw std::invalid_argument("invalid coordinate value");
 
-    index += coordinates[axis] * size;
-    size *= shape[axis];
+    index += coordinates[axis] * strides2[axis];
   }
 
-  assert(size == storage.size());
-  assert(index < storage.size());
-  return storage[index];
+  assert(index < (bits != nullptr ? bitvec_t::get_length(bits.get())
+                                   : storage->size()));
+  return index;
+}
+
+literal_t
+Tensor::__very_slow_get_value(const std::vector<int> &coords) const {
+  size_t index = __very_slow_get_index(coords);
+  if (bits != nullptr)
+    return bitvec_t::get_bit(bits.get(), index) ? Logic::TRUE : Logic::FALSE;
+  return (*storage)[index];
+}
+
+void Tensor::__very_slow_set_value(const std::vector<int> &coords,
+                                   literal_t literal) {
+  detach();
+  size_t index = __very_slow_get_index(coords);
+  if (bits != nullptr) {
+    if (literal != Logic::TRUE && literal != Logic::FALSE)
+      throw std::invalid_argument("boolean value must be true or false");
+    bitvec_t::set_bit(bits.get(), index, literal == Logic::TRUE);
+  } else
+    (*storage)[index] = literal;
 }
 
 Tensor Tensor::variable(const std::shared_ptr<Solver> &solver,
                         const std::vector<int> &shape, bool decision,
                         bool polarity) {
   Tensor tensor(solver, shape);
-  for (literal_t &value : tensor.storage)
+  for (literal_t &value : *tensor.storage)
     value = solver->add_variable(decision, polarity);
 
   return tensor;
 }
 
 Tensor Tensor::constant(const std::vector<int> &shape, bool value) {
-  Tensor tensor(BOOLEAN, shape);
-
-  literal_t literal = value ? BOOLEAN->TRUE : BOOLEAN->FALSE;
-  for (literal_t &lit : tensor.storage)
-    lit = literal;
-
-  return tensor;
+  std::shared_ptr<bitvec_t> bits = create_bits(get_storage_size(shape));
+  bitvec_t::fill(bits.get(), value);
+  return Tensor(shape, bits);
 }
 
 Tensor Tensor::diagonal(int dimension) {
-  Tensor tensor(BOOLEAN, {dimension, dimension});
+  std::vector<int> shape = {dimension, dimension};
+  std::shared_ptr<bitvec_t> bits = create_bits(get_storage_size(shape));
+  BitWriter writer(bits.get());
   for (int i = 0; i < dimension; i++)
     for (int j = 0; j < dimension; j++)
-      tensor.storage[i * dimension + j] =
-          (i == j) ? BOOLEAN->TRUE : BOOLEAN->FALSE;
+      writer.push(i == j);
+  writer.flush();
 
-  return tensor;
+  return Tensor(shape, bits);
 }
 
 Tensor Tensor::lessthan(int dimension) {
-  Tensor tensor(BOOLEAN, {dimension, dimension});
+  std::vector<int> shape = {dimension, dimension};
+  std::shared_ptr<bitvec_t> bits = create_bits(get_storage_size(shape));
+  BitWriter writer(bits.get());
   for (int i = 0; i < dimension; i++)
     for (int j = 0; j < dimension; j++)
-      tensor.storage[i * dimension + j] =
-          (i < j) ? BOOLEAN->TRUE : BOOLEAN->FALSE;
+      writer.push(i < j);
+  writer.flush();
 
-  return tensor;
+  return Tensor(shape, bits);
 }
 
-Tensor Tensor::polymer(const std::vector<int> &shape2,
-                       const std::vector<int> &mapping) const {
-
+std::vector<size_t> get_polymer_strides(const std::vector<int> &shape,
+                                        const std::vector<size_t> &strides,
+                                        const std::vector<int> &shape2,
+                                        const std::vector<int> &mapping) {
   if (shape.size() != mapping.size())
     throw std::invalid_argument("invalid coordinate mapping size");
 
-  Tensor tensor2(logic, shape2);
+  // validates the new dimensions
+  get_storage_size(shape2);
 
-  size_t size = 1;
   std::vector<size_t> stride2(shape2.size(), 0);
   for (size_t axis = 0; axis < shape.size(); axis++) {
     if (mapping[axis] < 0 || (size_t)mapping[axis] >= shape2.size())
@@ -169,44 +348,187 @@ Tensor Tensor::polymer(const std::vector<int> &shape2,
     if (shape[axis] != shape2[mapping[axis]])
       throw std::invalid_argument("invalid coordinate mapping value");
 
-    stride2[mapping[axis]] += size;
-    size *= shape[axis];
+    stride2[mapping[axis]] += strides[axis];
   }
 
-  View view;
-  for (size_t axis = 0; axis < shape2.size(); axis++)
-    view.add(shape2[axis], stride2[axis]);
+  return stride2;
+}
+
+Tensor Tensor::polymer(const std::vector<int> &shape2,
+                       const std::vector<int> &mapping) const {
+  UASAT_TRACE_SCOPE("polymer", shape, shape2);
+  std::vector<size_t> stride2 =
+      get_polymer_strides(shape, get_strides(), shape2, mapping);
+  if (bits != nullptr)
+    return Tensor(shape2, gather_bits(bits.get(), 0, shape2, stride2));
+  return Tensor(logic, shape2, storage, stride2);
+}
+
+Tensor Tensor::materialize() const {
+  if (strides.empty())
+    return *this;
 
+  UASAT_TRACE_SCOPE("materialize", shape, shape);
+  Tensor tensor2(logic, shape);
+  View view = get_view(shape, strides);
   do {
-    tensor2.storage[view.index] = storage[view.offset];
+    (*tensor2.storage)[view.index] = (*storage)[view.offset];
   } while (view.next());
 
   return tensor2;
 }
 
+Tensor Tensor::permute(const std::vector<int> &axes,
+                       const std::vector<int> &perm) const {
+  UASAT_TRACE_SCOPE("permute", shape, shape);
+  std::vector<bool> permuted(shape.size(), false);
+  for (int axis : axes) {
+    if (axis < 0 || (size_t)axis >= shape.size())
+      throw std::invalid_argument("invalid axis");
+    if ((size_t)shape[axis] != perm.size())
+      throw std::invalid_argument("invalid permutation length");
+    permuted[axis] = true;
+  }
+
+  for (int value : perm)
+    if (value < 0 || (size_t)value >= perm.size())
+      throw std::invalid_argument("invalid permutation");
+
+  std::vector<size_t> strides1 = get_strides();
+  std::vector<int> coords(shape.size(), 0);
+  auto next_offset = [&]() {
+    size_t offset = 0;
+    for (size_t i = 0; i < shape.size(); i++)
+      offset += (permuted[i] ? perm[coords[i]] : coords[i]) * strides1[i];
+
+    // the first coordinate changes the fastest
+    for (size_t i = 0; i < shape.size(); i++) {
+      if (++coords[i] < shape[i])
+        break;
+      coords[i] = 0;
+    }
+    return offset;
+  };
+
+  if (bits != nullptr) {
+    size_t size = get_storage_size(shape);
+    std::shared_ptr<bitvec_t> bits2 = create_bits(size);
+    BitWriter writer(bits2.get());
+    for (size_t index = 0; index < size; index++)
+      writer.push(bitvec_t::get_bit(bits.get(), next_offset()));
+    writer.flush();
+
+    return Tensor(shape, bits2);
+  }
+
+  Tensor tensor2(logic, shape);
+  for (literal_t &value : *tensor2.storage)
+    value = (*storage)[next_offset()];
+
+  return tensor2;
+}
+
+Tensor Tensor::contract(
+    const std::vector<int> &shape2, const std::vector<int> &mapping1,
+    const Tensor &tensor2, const std::vector<int> &mapping2,
+    literal_t (Logic::*combine)(literal_t, literal_t),
+    literal_t (Logic::*reduce)(const std::vector<literal_t> &)) const {
+  if (shape2.size() < 1)
+    throw std::invalid_argument("not enough tensor axes");
+  if (bits != nullptr || tensor2.bits != nullptr)
+    return unpack()
+        .contract(shape2, mapping1, tensor2.unpack(), mapping2, combine,
+                  reduce)
+        .pack();
+  UASAT_TRACE_SCOPE("contract", shape2, get_folded_shape(shape2));
+
+  std::vector<size_t> stride1 =
+      get_polymer_strides(shape, get_strides(), shape2, mapping1);
+  std::vector<size_t> stride2 = get_polymer_strides(
+      tensor2.shape, tensor2.get_strides(), shape2, mapping2);
+
+  std::shared_ptr<Logic> logic3 = Logic::join(logic, tensor2.logic);
+  std::vector<int> shape3(shape2.begin() + 1, shape2.end());
+  ProfileScope scope(*logic3, "contract");
+  Tensor tensor3(logic3, shape3);
+
+  // both views enumerate the coordinates of shape2 in the same order
+  View view1 = get_view(shape2, stride1);
+  View view2 = get_view(shape2, stride2);
+
+  Logic *logic4 = logic3.get();
+  std::vector<literal_t> lits(shape2[0]);
+  for (literal_t &value : *tensor3.storage) {
+    for (literal_t &lit : lits) {
+      lit = (logic4->*combine)((*storage)[view1.offset],
+                               (*tensor2.storage)[view2.offset]);
+      view1.next();
+      view2.next();
+    }
+    value = (logic4->*reduce)(lits);
+  }
+
+  return tensor3;
+}
+
+Tensor Tensor::lex_leq(const Tensor &tensor2) const {
+  if (shape != tensor2.shape)
+    throw std::invalid_argument("non-matching tensor shapes");
+  if ((bits != nullptr) != (tensor2.bits != nullptr))
+    return unpack().lex_leq(tensor2.unpack());
+  UASAT_TRACE_SCOPE("lex_leq", shape, std::vector<int>());
+
+  // at the first difference the second tensor decides, else equal is fine
+  if (bits != nullptr) {
+    uint64_t pos = bitvec_t::find_difference(bits.get(), tensor2.bits.get());
+    return constant({}, pos == bitvec_t::get_length(bits.get()) ||
+                            bitvec_t::get_bit(tensor2.bits.get(), pos));
+  }
+
+  std::shared_ptr<Logic> logic3 = Logic::join(logic, tensor2.logic);
+  Tensor source1 = materialize();
+  ProfileScope scope(*logic3, "lex_leq");
+  Tensor source2 = tensor2.materialize();
+
+  literal_t result = Logic::TRUE;
+  for (size_t i = source1.storage->size(); i-- > 0;) {
+    literal_t lit1 = (*source1.storage)[i];
+    literal_t lit2 = (*source2.storage)[i];
+    result =
+        logic3->logic_iff(logic3->logic_add(lit1, lit2), lit2, result);
+  }
+
+  Tensor tensor3(logic3, {});
+  (*tensor3.storage)[0] = result;
+  return tensor3;
+}
+
 Tensor Tensor::reshape(unsigned int rank, const std::vector<int> &dims) const {
-  if (rank < shape.size())
+  if (rank > shape.size())
     throw std::invalid_argument("invalid resize rank");
 
   std::vector<int> shape2(shape.size() - rank + dims.size());
   std::copy(dims.begin(), dims.end(), shape2.begin());
   std::copy(shape.begin() + rank, shape.end(), shape2.begin() + dims.size());
 
-  Tensor tensor2(logic, shape2);
-  if (storage.size() != tensor2.storage.size())
+  if (get_storage_size(shape2) != get_storage_size(shape))
     throw std::invalid_argument("invalid resize dims");
+  UASAT_TRACE_SCOPE("reshape", shape, shape2);
 
-  std::copy(storage.begin(), storage.end(), tensor2.storage.begin());
+  // the linear indices do not change, so contiguous storage can be shared
+  Tensor tensor2 = materialize();
+  tensor2.shape = shape2;
   return tensor2;
 }
 
 std::vector<Tensor> Tensor::slices() const {
   if (shape.size() < 1)
     throw std::invalid_argument("not enough tenxor axes");
+  UASAT_TRACE_SCOPE("slices", shape, get_folded_shape(shape));
 
+  Tensor tensor = materialize();
   size_t size1 = shape[0];
-  size_t size2 = storage.size() / size1;
-  assert(size1 * size2 == storage.size());
+  size_t size2 = get_storage_size(shape) / size1;
 
   std::vector<int> shape2(shape.size() - 1);
   std::copy(shape.begin() + 1, shape.end(), shape2.begin());
@@ -214,12 +536,23 @@ std::vector<Tensor> Tensor::slices() const {
   std::vector<Tensor> slices;
   slices.reserve(size1);
 
+  if (bits != nullptr) {
+    std::vector<size_t> strides2 = get_default_strides(shape2);
+    for (size_t &stride : strides2)
+      stride *= size1;
+    for (size_t j = 0; j < size1; j++)
+      slices.push_back(
+          Tensor(shape2, gather_bits(bits.get(), j, shape2, strides2)));
+
+    return slices;
+  }
+
   for (size_t i = 0; i < size1; i++)
     slices.push_back(Tensor(logic, shape2));
 
   for (size_t i = 0; i < size2; i++)
     for (size_t j = 0; j < size1; j++)
-      slices[j].storage[i] = storage[i * size1 + j];
+      (*slices[j].storage)[i] = (*tensor.storage)[i * size1 + j];
 
   return slices;
 }
@@ -240,37 +573,128 @@ Tensor Tensor::stack(const std::vector<Tensor> &slices) {
   }
 
   shape.insert(shape.begin(), slices.size());
-  Tensor tensor(logic, shape);
-
-  size_t size = slices[0].storage.size();
+  UASAT_TRACE_SCOPE("stack", slices[0].shape, shape);
+
+  if (logic == BOOLEAN) {
+    size_t size = get_storage_size(slices[0].shape);
+    std::shared_ptr<bitvec_t> bits = create_bits(size * dim);
+    BitWriter writer(bits.get());
+    for (size_t i = 0; i < size; i++)
+      for (size_t j = 0; j < dim; j++)
+        writer.push(bitvec_t::get_bit(slices[j].bits.get(), i));
+    writer.flush();
+
+    return Tensor(shape, bits);
+  }
 
-  for (size_t i = 0; i < size; i++)
-    for (size_t j = 0; j < slices.size(); j++)
-      tensor.storage[i * size + j] = slices[j].storage[i];
+  Tensor tensor(logic, shape);
+  for (size_t j = 0; j < dim; j++) {
+    Tensor slice = slices[j].materialize().unpack();
+    size_t size = slice.storage->size();
+    for (size_t i = 0; i < size; i++)
+      (*tensor.storage)[i * dim + j] = (*slice.storage)[i];
+  }
 
   return tensor;
 }
 
 Tensor Tensor::logic_not() const {
-  Tensor tensor2(logic, shape);
+  UASAT_TRACE_SCOPE("logic_not", shape, shape);
+  if (bits != nullptr) {
+    std::shared_ptr<bitvec_t> bits2 =
+        create_bits(bitvec_t::get_length(bits.get()));
+    bitvec_t::negate(bits2.get(), bits.get());
+    return Tensor(shape, bits2);
+  }
+
+  // negating the storage of a view keeps it lazy, unless it is sparse
+  if (!strides.empty() && storage->size() > get_storage_size(shape))
+    return materialize().logic_not();
 
-  for (size_t index = 0; index < tensor2.storage.size(); index++)
-    tensor2.storage[index] = logic->logic_not(storage[index]);
+  Tensor tensor2(logic, shape,
+                 std::make_shared<std::vector<literal_t>>(storage->size()),
+                 strides);
+
+  for (size_t index = 0; index < tensor2.storage->size(); index++)
+    (*tensor2.storage)[index] = logic->logic_not((*storage)[index]);
 
   return tensor2;
 }
 
+typedef void (*bits_bin_t)(bitvec_t *, const bitvec_t *, const bitvec_t *);
+
+/**
+ * Returns the word-wide kernel of the given binary operation on packed
+ * boolean values, or nullptr if there is none.
+ */
+bits_bin_t get_bits_bin(literal_t (Logic::*op)(literal_t, literal_t)) {
+  if (op == &Logic::logic_and)
+    return &bitvec_t::logic_and;
+  else if (op == &Logic::logic_or)
+    return &bitvec_t::logic_or;
+  else if (op == &Logic::logic_leq)
+    return &bitvec_t::logic_leq;
+  else if (op == &Logic::logic_add)
+    return &bitvec_t::logic_add;
+  else if (op == &Logic::logic_equ)
+    return &bitvec_t::logic_equ;
+  return nullptr;
+}
+
+typedef void (*bits_ter_t)(bitvec_t *, const bitvec_t *, const bitvec_t *,
+                           const bitvec_t *);
+
+/**
+ * Returns the word-wide kernel of the given ternary operation on packed
+ * boolean values, or nullptr if there is none.
+ */
+bits_ter_t
+get_bits_ter(literal_t (Logic::*op)(literal_t, literal_t, literal_t)) {
+  if (op == &Logic::logic_maj)
+    return &bitvec_t::logic_maj;
+  else if (op == &Logic::logic_iff)
+    return &bitvec_t::logic_iff;
+  return nullptr;
+}
+
 Tensor Tensor::logic_bin(literal_t (Logic::*op)(literal_t, literal_t),
                          const Tensor &tensor2) const {
   if (shape != tensor2.shape)
     throw std::invalid_argument("non-matching shape");
 
+  bits_bin_t kernel = bits != nullptr && tensor2.bits != nullptr
+                          ? get_bits_bin(op)
+                          : nullptr;
+  if (kernel == nullptr && (bits != nullptr || tensor2.bits != nullptr))
+    return unpack().logic_bin(op, tensor2.unpack()).pack();
+  UASAT_TRACE_SCOPE("logic_bin", shape, shape);
+
+  if (kernel != nullptr) {
+    std::shared_ptr<bitvec_t> bits3 =
+        create_bits(bitvec_t::get_length(bits.get()));
+    kernel(bits3.get(), bits.get(), tensor2.bits.get());
+    return Tensor(shape, bits3);
+  }
+
   std::shared_ptr<Logic> logic3 = Logic::join(logic, tensor2.logic);
   Tensor tensor3(logic3, shape);
+  ProfileScope scope(*logic3, "logic_bin");
+
+  if (!strides.empty() || !tensor2.strides.empty()) {
+    View view1 = get_view(shape, get_strides());
+    View view2 = get_view(shape, tensor2.get_strides());
+    do {
+      (*tensor3.storage)[view1.index] = (logic3.get()->*op)(
+          (*storage)[view1.offset], (*tensor2.storage)[view2.offset]);
+      view2.next();
+    } while (view1.next());
+
+    return tensor3;
+  }
 
-  for (size_t index = 0; index < tensor3.storage.size(); index++)
-    tensor3.storage[index] =
-        (logic3.get()->*op)(storage[index], tensor2.storage[index]);
+  for (size_t index = 0; index < tensor3.storage->size(); index++)
+    (*tensor3.storage)[index] =
+        (logic3.get()->*op)((*storage)[index], (*tensor2.storage)[index]);
 
   return tensor3;
 }
@@ -281,95 +705,222 @@ Tensor Tensor::logic_ter(literal_t (Logic::*op)(literal_t, literal_t,
   if (shape != tensor2.shape || shape != tensor3.shape)
     throw std::invalid_argument("non-matching shape");
 
+  bool packed =
+      bits != nullptr && tensor2.bits != nullptr && tensor3.bits != nullptr;
+  bits_ter_t kernel = packed ? get_bits_ter(op) : nullptr;
+  if (kernel == nullptr &&
+      (bits != nullptr || tensor2.bits != nullptr || tensor3.bits != nullptr))
+    return unpack().logic_ter(op, tensor2.unpack(), tensor3.unpack()).pack();
+  UASAT_TRACE_SCOPE("logic_ter", shape, shape);
+
+  if (kernel != nullptr) {
+    std::shared_ptr<bitvec_t> bits4 =
+        create_bits(bitvec_t::get_length(bits.get()));
+    kernel(bits4.get(), bits.get(), tensor2.bits.get(), tensor3.bits.get());
+    return Tensor(shape, bits4);
+  }
+
   std::shared_ptr<Logic> logic4 =
       Logic::join(Logic::join(logic, tensor2.logic), tensor3.logic);
   Tensor tensor4(logic4, shape);
+  ProfileScope scope(*logic4, "logic_ter");
+
+  if (!strides.empty() || !tensor2.strides.empty() ||
+      !tensor3.strides.empty()) {
+    View view1 = get_view(shape, get_strides());
+    View view2 = get_view(shape, tensor2.get_strides());
+    View view3 = get_view(shape, tensor3.get_strides());
+    do {
+      (*tensor4.storage)[view1.index] = (logic4.get()->*op)(
+          (*storage)[view1.offset], (*tensor2.storage)[view2.offset],
+          (*tensor3.storage)[view3.offset]);
+      view2.next();
+      view3.next();
+    } while (view1.next());
+
+    return tensor4;
+  }
 
-  for (size_t index = 0; index < tensor4.storage.size(); index++)
-    tensor4.storage[index] = (logic4.get()->*op)(
-        storage[index], tensor2.storage[index], tensor3.storage[index]);
+  for (size_t index = 0; index < tensor4.storage->size(); index++)
+    (*tensor4.storage)[index] =
+        (logic4.get()->*op)((*storage)[index], (*tensor2.storage)[index],
+                            (*tensor3.storage)[index]);
 
   return tensor4;
 }
 
-Tensor Tensor::fold_all() const {
-  std::vector<Tensor> tensors = slices();
-  assert(tensors.size() > 0);
+template <typename FUNC> Tensor Tensor::fold_lits(FUNC func) const {
+  if (shape.size() < 1)
+    throw std::invalid_argument("not enough tensor axes");
 
-  Tensor data = tensors[0];
-  for (size_t i = 1; i < tensors.size(); i++)
-    data = data.logic_and(tensors[i]);
+  size_t size1 = shape[0];
+  std::vector<int> shape2(shape.begin() + 1, shape.end());
+  Tensor tensor2(logic, shape2);
+
+  std::vector<size_t> strides1 = get_strides();
+  size_t stride0 = strides1[0];
+  strides1.erase(strides1.begin());
+  View view = get_view(shape2, strides1);
+
+  std::vector<literal_t> lits(size1);
+  do {
+    const literal_t *source = storage->data() + view.offset;
+    for (size_t i = 0; i < size1; i++)
+      lits[i] = source[i * stride0];
+    (*tensor2.storage)[view.index] = func(lits);
+  } while (view.next());
 
-  return data;
+  return tensor2;
 }
 
-Tensor Tensor::fold_any() const {
-  std::vector<Tensor> tensors = slices();
-  assert(tensors.size() > 0);
+template <typename PRED> Tensor Tensor::fold_bits(PRED pred) const {
+  if (shape.size() < 1)
+    throw std::invalid_argument("not enough tensor axes");
 
-  Tensor data = tensors[0];
-  for (size_t i = 1; i < tensors.size(); i++)
-    data = data.logic_or(tensors[i]);
+  // the first axis is the fastest changing, so each folded group of values
+  // is a contiguous range of the bits
+  size_t size1 = shape[0];
+  std::vector<int> shape2(shape.begin() + 1, shape.end());
+  size_t size2 = get_storage_size(shape2);
+  std::shared_ptr<bitvec_t> bits2 = create_bits(size2);
+  BitWriter writer(bits2.get());
+  for (size_t i = 0; i < size2; i++)
+    writer.push(pred(bitvec_t::count(bits.get(), i * size1, size1)));
+  writer.flush();
 
-  return data;
+  return Tensor(shape2, bits2);
 }
 
-Tensor Tensor::fold_sum() const {
-  std::vector<Tensor> tensors = slices();
-  assert(tensors.size() > 0);
-
-  Tensor data = tensors[0];
-  for (size_t i = 1; i < tensors.size(); i++)
-    data = data.logic_add(tensors[i]);
+Tensor Tensor::fold_nary(
+    literal_t (Logic::*op)(const std::vector<literal_t> &)) const {
+  UASAT_TRACE_SCOPE("fold_nary", shape, get_folded_shape(shape));
+  if (bits != nullptr && shape.size() >= 1) {
+    uint64_t size1 = shape[0];
+    if (op == &Logic::logic_all)
+      return fold_bits([size1](uint64_t count) { return count == size1; });
+    else if (op == &Logic::logic_any)
+      return fold_bits([](uint64_t count) { return count != 0; });
+    else if (op == &Logic::logic_sum)
+      return fold_bits([](uint64_t count) { return count % 2 != 0; });
+    return unpack().fold_nary(op).pack();
+  }
 
-  return data;
+  Logic *logic2 = logic.get();
+  ProfileScope scope(*logic2, "fold_nary");
+  return fold_lits([logic2, op](const std::vector<literal_t> &lits) {
+    return (logic2->*op)(lits);
+  });
 }
 
-Tensor Tensor::fold_one() const {
-  std::vector<Tensor> tensors = slices();
-  assert(tensors.size() > 0);
+Tensor Tensor::fold_atleast(int k) const {
+  UASAT_TRACE_SCOPE("fold_atleast", shape, get_folded_shape(shape));
+  if (bits != nullptr)
+    return fold_bits(
+        [k](uint64_t count) { return k <= 0 || count >= (uint64_t)k; });
+  Logic *logic2 = logic.get();
+  ProfileScope scope(*logic2, "fold_atleast");
+  return fold_lits([logic2, k](const std::vector<literal_t> &lits) {
+    return logic2->logic_atleast(lits, k);
+  });
+}
 
-  if (tensors.size() == 1)
-    return tensors[0];
+Tensor Tensor::fold_exactly(int k) const {
+  UASAT_TRACE_SCOPE("fold_exactly", shape, get_folded_shape(shape));
+  if (bits != nullptr)
+    return fold_bits(
+        [k](uint64_t count) { return k >= 0 && count == (uint64_t)k; });
+  Logic *logic2 = logic.get();
+  ProfileScope scope(*logic2, "fold_exactly");
+  return fold_lits([logic2, k](const std::vector<literal_t> &lits) {
+    return logic2->logic_exactly(lits, k);
+  });
+}
 
-  Tensor min1 = tensors[0].logic_or(tensors[1]);
-  Tensor min2 = tensors[0].logic_and(tensors[1]);
-  for (size_t i = 2; i < tensors.size(); i++) {
-    min2 = min2.logic_or(min1.logic_and(tensors[i]));
-    min1 = min1.logic_or(tensors[i]);
-  }
+Tensor Tensor::fold_amo(Logic::amo_encoding_t encoding) const {
+  UASAT_TRACE_SCOPE("fold_amo", shape, get_folded_shape(shape));
+  if (bits != nullptr)
+    return fold_bits([](uint64_t count) { return count <= 1; });
+  Logic *logic2 = logic.get();
+  ProfileScope scope(*logic2, "fold_amo");
+  return fold_lits([logic2, encoding](const std::vector<literal_t> &lits) {
+    return logic2->logic_amo(lits, encoding);
+  });
+}
 
-  return min1.logic_and(min2.logic_not());
+Tensor Tensor::fold_one(Logic::amo_encoding_t encoding) const {
+  UASAT_TRACE_SCOPE("fold_one", shape, get_folded_shape(shape));
+  if (bits != nullptr)
+    return fold_bits([](uint64_t count) { return count == 1; });
+  Logic *logic2 = logic.get();
+  ProfileScope scope(*logic2, "fold_one");
+  return fold_lits([logic2, encoding](const std::vector<literal_t> &lits) {
+    return logic2->logic_one(lits, encoding);
+  });
 }
 
 literal_t Tensor::get_scalar() const {
-  if (storage.size() != 1)
+  if (get_storage_size(shape) != 1)
     throw std::invalid_argument("tensor must be scalar");
-  return storage[0];
+  if (bits != nullptr)
+    return bitvec_t::get_bit(bits.get(), 0) ? Logic::TRUE : Logic::FALSE;
+  return (*storage)[0];
 }
 
 Tensor Tensor::get_solution(const std::shared_ptr<Solver> &solver) const {
   if (solver.get() != logic.get())
     throw std::invalid_argument("non-matching solver");
 
-  Tensor tensor(BOOLEAN, shape);
-  for (size_t index = 0; index < tensor.storage.size(); index++)
-    tensor.storage[index] = solver->get_solution(storage[index]);
+  Tensor source = materialize();
+  std::shared_ptr<bitvec_t> bits2 = create_bits(source.storage->size());
+  solver->get_solution(*source.storage, bits2.get());
 
-  return tensor;
+  return Tensor(shape, bits2);
+}
+
+Tensor Tensor::block_solution(const std::shared_ptr<Solver> &solver) const {
+  if (solver.get() != logic.get())
+    throw std::invalid_argument("non-matching solver");
+
+  Tensor source = materialize();
+  std::shared_ptr<bitvec_t> bits2 = create_bits(source.storage->size());
+  solver->get_solution(*source.storage, bits2.get());
+  solver->add_blocking_clause(*source.storage, bits2.get());
+
+  return Tensor(shape, bits2);
+}
+
+bitvec_t *Tensor::to_bitvec() const {
+  if (logic != BOOLEAN)
+    throw std::invalid_argument("tensor must be boolean");
+
+  bitvec_t *vec = bitvec_t::create(bitvec_t::get_length(bits.get()));
+  bitvec_t::copy(vec, bits.get());
+  return vec;
+}
+
+Tensor Tensor::from_bitvec(const std::vector<int> &shape,
+                           const bitvec_t *vec) {
+  size_t size = get_storage_size(shape);
+  if (bitvec_t::get_length(vec) != size)
+    throw std::invalid_argument("non-matching bit vector length");
+
+  std::shared_ptr<bitvec_t> bits = create_bits(size);
+  bitvec_t::copy(bits.get(), vec);
+  return Tensor(shape, bits);
 }
 
 void Tensor::extend_clause(std::vector<literal_t> &clause) const {
-  for (size_t index = 0; index < storage.size(); index++)
-    clause.push_back(storage[index]);
+  Tensor source = materialize().unpack();
+  clause.insert(clause.end(), source.storage->begin(), source.storage->end());
 }
 
 std::ostream &operator<<(std::ostream &out, const Tensor &tensor) {
+  Tensor source = tensor.materialize().unpack();
   out << '[';
-  for (size_t index = 0; index < tensor.storage.size(); index++) {
+  for (size_t index = 0; index < source.storage->size(); index++) {
     if (index != 0)
       out << ',';
-    out << tensor.storage[index];
+    out << (*source.storage)[index];
   }
   out << ']';
   return out;
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2016-2018, Miklos Maroti, University of Szeged
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uasat/trace.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace uasat {
+
+struct trace_event_t {
+  const char *name;
+  double begin; // microseconds since start
+  double duration;
+  int thread;
+  std::vector<int> shape;
+  std::vector<int> output;
+};
+
+/**
+ * The shared state of the tracer, the events of all threads are collected
+ * into a single list under the mutex.
+ */
+struct trace_state_t {
+  std::atomic<bool> recording{false};
+  std::mutex mutex;
+  std::chrono::steady_clock::time_point start;
+  std::vector<trace_event_t> events;
+  std::map<std::thread::id, int> threads;
+};
+
+trace_state_t &get_trace_state() {
+  static trace_state_t state;
+  return state;
+}
+
+void Tracer::start() {
+  trace_state_t &state = get_trace_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.events.clear();
+  state.threads.clear();
+  state.start = std::chrono::steady_clock::now();
+  state.recording = true;
+}
+
+void Tracer::stop() { get_trace_state().recording = false; }
+
+bool Tracer::is_recording() { return get_trace_state().recording; }
+
+void Tracer::record(const char *name,
+                    std::chrono::steady_clock::time_point begin,
+                    std::chrono::steady_clock::time_point end,
+                    const std::vector<int> &shape,
+                    const std::vector<int> &output) {
+  trace_state_t &state = get_trace_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (!state.recording)
+    return;
+
+  std::map<std::thread::id, int>::iterator iter =
+      state.threads
+          .insert(std::make_pair(std::this_thread::get_id(),
+                                 int(state.threads.size()) + 1))
+          .first;
+
+  std::chrono::duration<double, std::micro> offset = begin - state.start;
+  std::chrono::duration<double, std::micro> duration = end - begin;
+  state.events.push_back(trace_event_t{name, offset.count(), duration.count(),
+                                       iter->second, shape, output});
+}
+
+void write_trace_shape(std::ostream &out, const std::vector<int> &shape) {
+  out << '[';
+  for (size_t i = 0; i < shape.size(); i++)
+    out << (i != 0 ? "," : "") << shape[i];
+  out << ']';
+}
+
+void Tracer::write(std::ostream &out) {
+  trace_state_t &state = get_trace_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+
+  out << "{\"traceEvents\": [";
+  for (size_t i = 0; i < state.events.size(); i++) {
+    const trace_event_t &event = state.events[i];
+    out << (i != 0 ? ",\n" : "\n") << "{\"name\": \"" << event.name
+        << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+        << ", \"ts\": " << event.begin << ", \"dur\": " << event.duration;
+    if (!event.shape.empty() || !event.output.empty()) {
+      size_t size = 1;
+      for (int dim : event.output)
+        size *= dim;
+      out << ", \"args\": {\"shape\": \"";
+      write_trace_shape(out, event.shape);
+      out << "\", \"output\": \"";
+      write_trace_shape(out, event.output);
+      out << "\", \"size\": " << size << "}";
+    }
+    out << "}";
+  }
+  out << "\n], \"displayTimeUnit\": \"ms\"}" << std::endl;
+}
+
+TraceScope::TraceScope(const char *name)
+    : name(name), recording(Tracer::is_recording()) {
+  if (recording)
+    begin = std::chrono::steady_clock::now();
+}
+
+TraceScope::TraceScope(const char *name, const std::vector<int> &shape,
+                       const std::vector<int> &output)
+    : name(name), recording(Tracer::is_recording()) {
+  if (recording) {
+    this->shape = shape;
+    this->output = output;
+    begin = std::chrono::steady_clock::now();
+  }
+}
+
+TraceScope::~TraceScope() {
+  if (recording)
+    Tracer::record(name, begin, std::chrono::steady_clock::now(), shape,
+                   output);
+}
+
+} // namespace uasat